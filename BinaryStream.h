@@ -0,0 +1,135 @@
+/*
+Small helpers for writing and reading compact binary data (used to save and restore boards).
+
+Integers are written little endian or as LEB128 style variable length values so the data is the
+same on every platform, and FNV-1a is used as a cheap hash to detect corrupt or truncated data.
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/// <summary>
+/// FNV-1a 64 bit hash of a block of memory
+/// </summary>
+inline uint64_t HashBytes(const char *data, size_t size, uint64_t hash = 14695981039346656037ULL)
+{
+	for (size_t i = 0; i < size; i++)
+	{
+		hash ^= uint8_t(data[i]);
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+/// <summary>
+/// Appends binary values to a vector of bytes
+/// </summary>
+class BinaryWriter
+{
+public:
+	BinaryWriter(std::vector<char> &output) : m_output(output) {}
+
+	void Bytes(const char *data, size_t size) { m_output.insert(m_output.end(), data, data + size); }
+	void Byte(uint8_t value) { m_output.push_back(char(value)); }
+	void Fill(char value, size_t count) { m_output.insert(m_output.end(), count, value); }
+
+	void UInt16(uint16_t value)
+	{
+		Byte(uint8_t(value));
+		Byte(uint8_t(value >> 8));
+	}
+
+	void UInt64(uint64_t value)
+	{
+		for (int i = 0; i < 8; i++)
+			Byte(uint8_t(value >> (i * 8)));
+	}
+
+	void VarUInt(uint64_t value) // 7 bits per byte, high bit set when more bytes follow
+	{
+		while (value >= 0x80)
+		{
+			Byte(uint8_t(value | 0x80));
+			value >>= 7;
+		}
+		Byte(uint8_t(value));
+	}
+
+	size_t Size() const { return m_output.size(); }
+
+private:
+	std::vector<char> &m_output;
+};
+
+/// <summary>
+/// Reads binary values written by BinaryWriter.  Every read checks the remaining size, after the
+/// first failure all further reads fail (so a sequence of reads can be checked once at the end).
+/// </summary>
+class BinaryReader
+{
+public:
+	BinaryReader(const char *data, size_t size) : m_data(data), m_size(size), m_pos(0), m_ok(true) {}
+
+	bool IsOk() const { return m_ok; }
+	size_t Position() const { return m_pos; }
+	size_t Remaining() const { return m_size - m_pos; }
+
+	const char *Bytes(size_t size) // returns a pointer to the next size bytes (NULL if not enough data)
+	{
+		if (!m_ok || (size > Remaining()))
+		{
+			m_ok = false;
+			return NULL;
+		}
+		const char *data = m_data + m_pos;
+		m_pos += size;
+		return data;
+	}
+
+	uint8_t Byte()
+	{
+		const char *data = Bytes(1);
+		return (NULL != data) ? uint8_t(*data) : 0;
+	}
+
+	uint16_t UInt16()
+	{
+		const char *data = Bytes(2);
+		return (NULL != data) ? uint16_t(uint8_t(data[0]) | (uint8_t(data[1]) << 8)) : 0;
+	}
+
+	uint64_t UInt64()
+	{
+		uint64_t value = 0;
+		const char *data = Bytes(8);
+		if (NULL != data)
+		{
+			for (int i = 0; i < 8; i++)
+				value |= uint64_t(uint8_t(data[i])) << (i * 8);
+		}
+		return value;
+	}
+
+	uint64_t VarUInt()
+	{
+		uint64_t value = 0;
+		for (int shift = 0; m_ok && (shift < 64); shift += 7)
+		{
+			uint8_t byte = Byte();
+			value |= uint64_t(byte & 0x7F) << shift;
+			if (0 == (byte & 0x80))
+				return value;
+		}
+		m_ok = false;
+		return 0;
+	}
+
+private:
+	const char *m_data;
+	size_t m_size;
+	size_t m_pos;
+	bool m_ok;
+};
@@ -0,0 +1,260 @@
+/*
+Storage for the squares of a WordBoard.  The board logic (BasicWordBoard) is written once against
+this small interface so the same code runs on boards sized at runtime and boards sized at compile
+time:
+
+	bool Resize(int width, int height)               set the size (contents undefined until Fill)
+	int Width() / Height()                           board size
+	char Get(row, col) / void Set(row, col, value)   single square
+	ReadH / WriteH / ReadV / WriteV                  runs of squares left->right or top->down
+	void Fill(char value)                            set every square
+
+Callers do the range checking, the storage does none.  DynamicBoardStorage and FixedBoardStorage hold
+every square, SparseBoardStorage only the parts of a huge board that have letters.
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// Board squares sized at runtime, held in one contiguous row major block
+/// </summary>
+class DynamicBoardStorage
+{
+public:
+	DynamicBoardStorage() : m_width(0), m_height(0) {}
+
+	bool Resize(int width, int height)
+	{
+		if ((width < 1) || (height < 1))
+			return false;
+		m_width = width;
+		m_height = height;
+		m_cells.resize(size_t(width) * size_t(height));
+		return true;
+	}
+
+	int Width() const { return m_width; }
+	int Height() const { return m_height; }
+
+	char Get(int row, int col) const { return m_cells[Index(row, col)]; }
+	void Set(int row, int col, char value) { m_cells[Index(row, col)] = value; }
+
+	void ReadH(int row, int col, int count, char *output) const { memcpy(output, m_cells.data() + Index(row, col), size_t(count)); }
+	void WriteH(int row, int col, const char *value, int count) { memcpy(m_cells.data() + Index(row, col), value, size_t(count)); }
+	void ReadV(int row, int col, int count, char *output) const
+	{
+		const char *cell = m_cells.data() + Index(row, col);
+		for (int i = 0; i < count; i++, cell += m_width)
+			output[i] = *cell;
+	}
+	void WriteV(int row, int col, const char *value, int count)
+	{
+		char *cell = m_cells.data() + Index(row, col);
+		for (int i = 0; i < count; i++, cell += m_width)
+			*cell = value[i];
+	}
+
+	void Fill(char value) { std::fill(m_cells.begin(), m_cells.end(), value); }
+
+private:
+	size_t Index(int row, int col) const { return size_t(row) * size_t(m_width) + size_t(col); }
+
+	int m_width;
+	int m_height;
+	std::vector<char> m_cells;
+};
+
+/// <summary>
+/// Board squares sized at compile time - held inline (no heap) with constant bounds and strides
+/// </summary>
+template <int W, int H>
+class FixedBoardStorage
+{
+	static_assert((W > 0) && (H > 0), "Board must be at least 1x1");
+public:
+	FixedBoardStorage() { m_cells.fill(' '); }
+
+	bool Resize(int width, int height) { return (W == width) && (H == height); } // the size cannot change
+
+	static int Width() { return W; }
+	static int Height() { return H; }
+
+	char Get(int row, int col) const { return m_cells[Index(row, col)]; }
+	void Set(int row, int col, char value) { m_cells[Index(row, col)] = value; }
+
+	void ReadH(int row, int col, int count, char *output) const { memcpy(output, m_cells.data() + Index(row, col), size_t(count)); }
+	void WriteH(int row, int col, const char *value, int count) { memcpy(m_cells.data() + Index(row, col), value, size_t(count)); }
+	void ReadV(int row, int col, int count, char *output) const
+	{
+		const char *cell = m_cells.data() + Index(row, col);
+		for (int i = 0; i < count; i++, cell += W)
+			output[i] = *cell;
+	}
+	void WriteV(int row, int col, const char *value, int count)
+	{
+		char *cell = m_cells.data() + Index(row, col);
+		for (int i = 0; i < count; i++, cell += W)
+			*cell = value[i];
+	}
+
+	void Fill(char value) { m_cells.fill(value); }
+
+private:
+	static size_t Index(int row, int col) { return size_t(row) * W + size_t(col); }
+
+	std::array<char, size_t(W) * H> m_cells;
+};
+
+/// <summary>
+/// Board squares for very large, mostly empty boards.  The board is split into 64x64 tiles that are only
+/// allocated when a letter is written into them (and freed again when they become empty), found through a
+/// hash of the tile coordinates.  Memory is proportional to the tiles holding letters and runs of squares
+/// only visit the tiles they cross.
+/// </summary>
+class SparseBoardStorage
+{
+public:
+	enum { TileShift = 6, TileSize = 1 << TileShift, TileMask = TileSize - 1 };
+
+	SparseBoardStorage() : m_width(0), m_height(0) {}
+
+	bool Resize(int width, int height)
+	{
+		if ((width < 1) || (height < 1))
+			return false;
+		m_width = width;
+		m_height = height;
+		m_tiles.clear();
+		return true;
+	}
+
+	int Width() const { return m_width; }
+	int Height() const { return m_height; }
+	size_t GetTileCount() const { return m_tiles.size(); } // tiles currently allocated
+
+	char Get(int row, int col) const
+	{
+		const Tile *tile = FindTile(row, col);
+		return (NULL != tile) ? tile->m_cells[Offset(row, col)] : ' ';
+	}
+	void Set(int row, int col, char value) { WriteH(row, col, &value, 1); }
+
+	void ReadH(int row, int col, int count, char *output) const
+	{
+		while (count > 0)
+		{
+			int run = std::min(count, int(TileSize - (col & TileMask)));
+			const Tile *tile = FindTile(row, col);
+			if (NULL != tile)
+				memcpy(output, tile->m_cells + Offset(row, col), size_t(run));
+			else
+				memset(output, ' ', size_t(run));
+			output += run;
+			col += run;
+			count -= run;
+		}
+	}
+	void WriteH(int row, int col, const char *value, int count)
+	{
+		while (count > 0)
+		{
+			int run = std::min(count, int(TileSize - (col & TileMask)));
+			WriteRun(row, col, value, run, 1);
+			value += run;
+			col += run;
+			count -= run;
+		}
+	}
+	void ReadV(int row, int col, int count, char *output) const
+	{
+		while (count > 0)
+		{
+			int run = std::min(count, int(TileSize - (row & TileMask)));
+			const Tile *tile = FindTile(row, col);
+			for (int i = 0; i < run; i++)
+				output[i] = (NULL != tile) ? tile->m_cells[Offset(row + i, col)] : ' ';
+			output += run;
+			row += run;
+			count -= run;
+		}
+	}
+	void WriteV(int row, int col, const char *value, int count)
+	{
+		while (count > 0)
+		{
+			int run = std::min(count, int(TileSize - (row & TileMask)));
+			WriteRun(row, col, value, run, TileSize);
+			value += run;
+			row += run;
+			count -= run;
+		}
+	}
+
+	void Fill(char value)
+	{
+		m_tiles.clear(); // every square is empty
+		if (' ' != value)
+		{
+			std::vector<char> row(size_t(m_width), value);
+			for (int nRow = 0; nRow < m_height; nRow++)
+				WriteH(nRow, 0, row.data(), m_width);
+		}
+	}
+
+private:
+	class Tile
+	{
+	public:
+		Tile() : m_occupied(0) { memset(m_cells, ' ', sizeof(m_cells)); }
+		char m_cells[TileSize * TileSize];
+		int m_occupied; // squares holding something other than ' ', the tile is freed when this drops to 0
+	};
+
+	static uint64_t Key(int row, int col) { return (uint64_t(uint32_t(row >> TileShift)) << 32) | uint32_t(col >> TileShift); }
+	static int Offset(int row, int col) { return ((row & TileMask) << TileShift) | (col & TileMask); }
+
+	const Tile *FindTile(int row, int col) const
+	{
+		auto found = m_tiles.find(Key(row, col));
+		return (m_tiles.end() != found) ? found->second.get() : NULL;
+	}
+
+	/// <summary>
+	/// Writes count squares inside one tile, offset 'step' apart in the tile (1 across, TileSize down).
+	/// </summary>
+	void WriteRun(int row, int col, const char *value, int count, int step)
+	{
+		uint64_t key = Key(row, col);
+		auto found = m_tiles.find(key);
+		if (m_tiles.end() == found)
+		{
+			bool empty = true;
+			for (int i = 0; empty && (i < count); i++)
+				empty = (' ' == value[i]);
+			if (empty)
+				return; // writing spaces to an empty tile changes nothing, do not allocate it
+			found = m_tiles.emplace(key, std::unique_ptr<Tile>(new Tile())).first;
+		}
+		Tile &tile = *found->second;
+		char *cell = tile.m_cells + Offset(row, col);
+		for (int i = 0; i < count; i++, cell += step)
+		{
+			tile.m_occupied += int(' ' != value[i]) - int(' ' != *cell);
+			*cell = value[i];
+		}
+		if (0 == tile.m_occupied)
+			m_tiles.erase(found);
+	}
+
+	int m_width;
+	int m_height;
+	std::unordered_map<uint64_t, std::unique_ptr<Tile>> m_tiles;
+};
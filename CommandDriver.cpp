@@ -0,0 +1,412 @@
+/*
+Runs WordBoard commands read from a stream - see CommandDriver.h for the protocol
+*/
+
+#include "stdafx.h"
+#include "CommandDriver.h"
+#include "LineParser.h"
+#include <algorithm>
+#include <chrono>
+#include <cerrno>
+#include <cstring>
+#include <new>
+#if defined(_WIN32)
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace
+{
+	const size_t ReadChunk = 64 * 1024;
+
+	/// <summary>
+	/// Reads whatever is available (at least one byte, blocking until then) - 0 at the end of the input,
+	/// -1 on an error.  A read interrupted by a signal is retried.
+	/// </summary>
+	int ReadInput(int input, char *buffer, size_t size)
+	{
+		int read;
+		do
+		{
+#if defined(_WIN32)
+			read = ::_read(input, buffer, unsigned(size));
+#else
+			read = int(::read(input, buffer, size));
+#endif
+		} while ((read < 0) && (EINTR == errno));
+		return read;
+	}
+
+	void AppendError(std::string &response, const char *text)
+	{
+		response += " error ";
+		response += text;
+	}
+}
+
+CommandDriver::CommandDriver()
+	: m_readInput(-1)
+	, m_reading(false)
+	, m_readEnded(false)
+	, m_shutdown(false)
+	, m_readSize(0)
+	, m_inputEnded(false)
+	, m_threadCount(0)
+	, m_batchSize(4096)
+	, m_commandCount(0)
+	, m_batchCount(0)
+	, m_elapsedSeconds(0.0)
+{
+}
+
+CommandDriver::~CommandDriver()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_readLock);
+		m_shutdown = true;
+	}
+	m_readChanged.notify_all();
+	if (m_reader.joinable())
+		m_reader.join();
+}
+
+/// <summary>
+/// Sets the word list used by every game.
+/// </summary>
+/// <param name="validator">The loaded word list.</param>
+/// <returns>true on success</returns>
+bool CommandDriver::Initialize(std::shared_ptr<const WordValidator> validator)
+{
+	m_validator = validator;
+	return nullptr != m_validator;
+}
+
+/// <summary>
+/// Runs commands until the input ends, writing the responses as each batch completes.
+/// </summary>
+/// <param name="input">The file descriptor to read commands from (0 for stdin).</param>
+/// <param name="output">Where to write the responses.</param>
+/// <returns>true if every command was read and answered, false if not initialized or reading or writing failed</returns>
+bool CommandDriver::Run(int input, FILE *output)
+{
+	m_commandCount = 0;
+	m_batchCount = 0;
+	m_elapsedSeconds = 0.0;
+	if (!m_validator)
+		return false;
+
+	auto start = std::chrono::steady_clock::now();
+	m_pool.Start(m_threadCount); // threads are only started the first time (or if the count changes)
+	m_workers.resize(size_t(m_pool.GetThreadCount()));
+	for (auto &worker : m_workers)
+	{
+		if (!worker)
+			worker.reset(new WorkerState());
+	}
+	if (!m_reader.joinable())
+		m_reader = std::thread([this]() { ReadLoop(); });
+
+	// Hand the input to the reader, which reads ahead into whichever batch is free
+	{
+		std::lock_guard<std::mutex> lock(m_readLock);
+		m_readSize = 0;
+		m_inputEnded = false;
+		m_readEnded = false;
+		m_readError.clear();
+		m_readBatches.clear();
+		m_freeBatches.assign({ &m_batches[0], &m_batches[1] });
+		m_readInput = input;
+	}
+	m_readChanged.notify_all();
+
+	bool success = true;
+	while (success)
+	{
+		Batch *batch = NULL;
+		{
+			std::unique_lock<std::mutex> lock(m_readLock);
+			m_readChanged.wait(lock, [this]() { return !m_readBatches.empty() || m_readEnded; });
+			if (m_readBatches.empty())
+				break;
+			batch = m_readBatches.front();
+			m_readBatches.pop_front();
+		}
+		PrepareBatch(*batch);
+		ExecuteBatch(*batch);
+		success = WriteBatch(*batch, output);
+		m_commandCount += batch->m_commandCount;
+		m_batchCount++;
+		{
+			std::lock_guard<std::mutex> lock(m_readLock);
+			m_freeBatches.push_back(batch);
+		}
+		m_readChanged.notify_all();
+	}
+
+	// Stop the reader (if writing failed it may still be reading) and wait until it is idle
+	{
+		std::unique_lock<std::mutex> lock(m_readLock);
+		m_readInput = -1;
+		m_readChanged.wait(lock, [this]() { return !m_reading; });
+		m_readBatches.clear();
+	}
+
+	m_elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return success && m_readError.empty();
+}
+
+/// <summary>
+/// The reader thread - while a Run is in progress, reads each batch into a free one and queues it.
+/// </summary>
+void CommandDriver::ReadLoop()
+{
+	std::unique_lock<std::mutex> lock(m_readLock);
+	for (;;)
+	{
+		m_readChanged.wait(lock, [this]() { return m_shutdown || ((m_readInput >= 0) && !m_readEnded && !m_freeBatches.empty()); });
+		if (m_shutdown)
+			break;
+		Batch *batch = m_freeBatches.back();
+		m_freeBatches.pop_back();
+		int input = m_readInput;
+		m_reading = true;
+		lock.unlock();
+		bool read = ReadBatch(input, *batch);
+		lock.lock();
+		m_reading = false;
+		if (read)
+			m_readBatches.push_back(batch);
+		else
+		{
+			m_freeBatches.push_back(batch);
+			m_readEnded = true;
+		}
+		m_readChanged.notify_all();
+	}
+}
+
+/// <summary>
+/// Takes the complete lines read so far (up to the batch size) as the next batch, reading more input
+/// only when there is not a single complete line yet.  The last line does not need a '\n'.
+/// </summary>
+/// <returns>true if a batch was read, false at the end of the input (or after a read error, see m_readError)</returns>
+bool CommandDriver::ReadBatch(int input, Batch &batch)
+{
+	batch.m_text.clear();
+	size_t maxLines = size_t(std::max(m_batchSize, 1));
+	for (;;)
+	{
+		size_t taken = 0;
+		for (size_t lines = 0; lines < maxLines; lines++)
+		{
+			size_t lineEnd = FindLineEnd(m_readBuffer.data(), taken, m_readSize);
+			if (lineEnd == m_readSize)
+				break;
+			taken = lineEnd + 1;
+		}
+		if (m_inputEnded && (0 == taken))
+			taken = m_readSize; // last line without a '\n'
+		if (taken > 0)
+		{
+			batch.m_text.assign(m_readBuffer.begin(), m_readBuffer.begin() + taken);
+			memmove(m_readBuffer.data(), m_readBuffer.data() + taken, m_readSize - taken);
+			m_readSize -= taken;
+			return true;
+		}
+		if (m_inputEnded)
+			return false;
+
+		if (m_readBuffer.size() < (m_readSize + ReadChunk))
+			m_readBuffer.resize(m_readSize + ReadChunk);
+		int read = ReadInput(input, m_readBuffer.data() + m_readSize, ReadChunk);
+		if (read > 0)
+			m_readSize += size_t(read);
+		else
+		{
+			if (read < 0)
+				m_readError = "Error reading commands (errno " + std::to_string(errno) + ")";
+			m_inputEnded = true; // the lines already read are still run
+		}
+	}
+}
+
+/// <summary>
+/// Splits the batch into commands and queues each one on its game (creating games the first time an id is seen).
+/// </summary>
+void CommandDriver::PrepareBatch(Batch &batch)
+{
+	batch.m_commandCount = 0;
+	batch.m_games.clear();
+	const char *text = batch.m_text.data();
+	size_t size = batch.m_text.size();
+	for (size_t pos = 0; pos < size; )
+	{
+		size_t lineEnd = FindLineEnd(text, pos, size);
+		LineParser parser(text + pos, text + lineEnd);
+		const char *gameId;
+		int gameIdLength;
+		if (!parser.IsEmpty() && parser.Token(gameId, gameIdLength))
+		{
+			m_gameKey.assign(gameId, gameIdLength);
+			std::unique_ptr<Game> &game = m_games[m_gameKey];
+			if (!game)
+				game.reset(new Game());
+			if (game->m_pending.empty())
+				batch.m_games.push_back(game.get());
+			game->m_pending.push_back(batch.m_commandCount);
+
+			if (batch.m_commands.size() <= batch.m_commandCount)
+				batch.m_commands.resize(batch.m_commandCount + 1);
+			Command &command = batch.m_commands[batch.m_commandCount++];
+			command.m_begin = pos;
+			command.m_end = lineEnd;
+			command.m_game = game.get();
+		}
+		pos = lineEnd + 1;
+	}
+}
+
+/// <summary>
+/// Executes the batch - games in parallel, each game's commands in order on one thread.
+/// </summary>
+void CommandDriver::ExecuteBatch(Batch &batch)
+{
+	m_pool.Run(batch.m_games.size(), 1, [&](size_t index, int threadIndex)
+	{
+		Game &game = *batch.m_games[index];
+		for (size_t command : game.m_pending)
+			Execute(batch, batch.m_commands[command], *m_workers[threadIndex]);
+	});
+	for (Game *game : batch.m_games)
+		game->m_pending.clear();
+}
+
+/// <summary>
+/// Writes the responses in the order the commands were read.
+/// </summary>
+/// <returns>true on success, false if writing failed</returns>
+bool CommandDriver::WriteBatch(const Batch &batch, FILE *output)
+{
+	for (size_t index = 0; index < batch.m_commandCount; index++)
+	{
+		const std::string &response = batch.m_commands[index].m_response;
+		fwrite(response.data(), 1, response.length(), output);
+		fputc('\n', output);
+	}
+	return (0 == fflush(output)) && (0 == ferror(output));
+}
+
+/// <summary>
+/// Executes one command on its game and sets its response.
+/// </summary>
+void CommandDriver::Execute(const Batch &batch, Command &command, WorkerState &worker)
+{
+	LineParser parser(batch.m_text.data() + command.m_begin, batch.m_text.data() + command.m_end);
+	const char *token;
+	int length;
+	parser.Token(token, length); // game id
+	std::string &response = command.m_response;
+	response.assign(token, length);
+
+	Game &game = *command.m_game;
+	WordBoard &board = game.m_board;
+	const char *word;
+	int wordLength;
+	int row = 0;
+	int col = 0;
+	if (!parser.Token(token, length))
+		AppendError(response, "Missing command");
+	else if (IsToken(token, length, "init"))
+	{
+		if (!parser.Number(col) || !parser.Number(row) || !parser.AtEnd())
+			AppendError(response, "Unable to parse command, expected: <game> init <width> <height>");
+		else if ((col <= 0) || (row <= 0) || ((uint64_t(col) * uint64_t(row)) > MaxBoardCells))
+		{
+			game.m_initialized = false;
+			AppendError(response, "Board size is not allowed");
+		}
+		else
+		{
+			try
+			{
+				game.m_initialized = board.Init(col, row, m_validator);
+			}
+			catch (const std::bad_alloc &)
+			{
+				game.m_initialized = false; // one game out of memory must not end every other game
+			}
+			if (game.m_initialized)
+				response += " ok";
+			else
+				AppendError(response, "Unable to initialize the board");
+		}
+	}
+	else if (IsToken(token, length, "validate-batch"))
+	{
+		response += " ok ";
+		while (parser.Token(word, wordLength))
+		{
+			worker.m_word.assign(word, wordLength);
+			response += m_validator->isValid(worker.m_word) ? '1' : '0';
+		}
+	}
+	else if (!game.m_initialized)
+		AppendError(response, "Game not initialized, expected: <game> init <width> <height>");
+	else if (IsToken(token, length, "add-h") || IsToken(token, length, "add-v"))
+	{
+		bool horizontal = ('h' == token[4]);
+		if (!parser.Number(row) || !parser.Number(col) || !parser.Token(word, wordLength) || !parser.AtEnd())
+			AppendError(response, "Unable to parse command, expected: <game> add-h|add-v <row> <col> <WORD>");
+		else
+		{
+			worker.m_word.assign(word, wordLength);
+			int score = 0;
+			bool added = horizontal ? board.AddWordH(row, col, worker.m_word, worker.m_errorText, score) :
+				board.AddWordV(row, col, worker.m_word, worker.m_errorText, score);
+			if (added)
+			{
+				response += " ok ";
+				response += std::to_string(score);
+			}
+			else
+				AppendError(response, worker.m_errorText.c_str());
+		}
+	}
+	else if (IsToken(token, length, "undo") || IsToken(token, length, "redo"))
+	{
+		bool undo = ('u' == token[0]);
+		if (!parser.AtEnd())
+			AppendError(response, "Unable to parse command, expected: <game> undo|redo");
+		else if (undo ? board.Undo(worker.m_errorText) : board.Redo(worker.m_errorText))
+			response += " ok";
+		else
+			AppendError(response, worker.m_errorText.c_str());
+	}
+	else if (IsToken(token, length, "query"))
+	{
+		if (!parser.AtEnd() || !board.GetBoard(worker.m_rows))
+			AppendError(response, "Unable to parse command, expected: <game> query");
+		else
+		{
+			response += " ok ";
+			response += std::to_string(board.GetNumColumns());
+			response += ' ';
+			response += std::to_string(board.GetNumRows());
+			response += ' ';
+			for (size_t nRow = 0; nRow < worker.m_rows.size(); nRow++)
+			{
+				if (nRow > 0)
+					response += '/';
+				size_t first = response.length();
+				response += worker.m_rows[nRow];
+				std::replace(response.begin() + first, response.end(), ' ', '.');
+			}
+		}
+	}
+	else
+	{
+		AppendError(response, "Unknown command: ");
+		response.append(token, length);
+	}
+}
@@ -0,0 +1,132 @@
+/*
+Runs WordBoard commands read from a stream, so other processes can drive boards without linking the
+library.  The protocol is one command per line, each starting with the id of the game it is for:
+
+	<game> init <width> <height>             ok
+	<game> add-h <row> <col> <WORD>          ok <score>
+	<game> add-v <row> <col> <WORD>          ok <score>
+	<game> undo                              ok
+	<game> redo                              ok
+	<game> query                             ok <width> <height> <row>/<row>/...  (empty squares are '.')
+	<game> validate-batch <WORD> <WORD> ...  ok <1 or 0 per word, e.g. 101>
+
+Every command gets exactly one response line "<game> ok ..." or "<game> error <text>".  Blank lines
+and lines starting with '#' are ignored.  Any number of games can be open at once, each with its own id.
+init refuses boards of more than MaxBoardCells squares (see WordBoard.h).
+
+Commands are executed in batches - whatever complete lines have arrived, up to the batch size.  Within
+a batch the games run in parallel on a pool of threads while each game's commands run in order, and the
+responses are written in the order the commands were read.  The next batch is read (by a reader thread)
+while the current one executes, so a client that streams commands without waiting for responses keeps
+every thread busy, and a client that waits for each response still gets it straight away.  The reader
+and the worker threads are started once and kept for the life of the driver.
+*/
+
+#pragma once
+
+#include "WordBoard.h"
+#include "ParallelFor.h"
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+class CommandDriver
+{
+public:
+	CommandDriver();
+	~CommandDriver();
+
+	bool Initialize(std::shared_ptr<const WordValidator> validator); // word list shared by every game's board
+
+	// Tuning - number of worker threads (0 = all hardware threads) and the most commands executed as one batch
+	void SetThreadCount(int threadCount) { m_threadCount = threadCount; }
+	void SetBatchSize(int batchSize) { m_batchSize = batchSize; }
+
+	bool Run(int input, FILE *output); // runs commands from the file descriptor until it ends
+	const std::string &GetReadError() const { return m_readError; } // why reading stopped, empty if the input ended
+
+	// Statistics from the last Run
+	size_t GetCommandCount() const { return m_commandCount; }
+	size_t GetBatchCount() const { return m_batchCount; }
+	size_t GetGameCount() const { return m_games.size(); }
+	double GetElapsedSeconds() const { return m_elapsedSeconds; }
+	double GetCommandsPerSecond() const { return (m_elapsedSeconds > 0.0) ? double(m_commandCount) / m_elapsedSeconds : 0.0; }
+
+private:
+	class Game
+	{
+	public:
+		Game() : m_initialized(false) {}
+
+		WordBoard m_board;
+		bool m_initialized;
+		std::vector<size_t> m_pending; // this game's commands in the current batch, in order
+	};
+
+	class Command
+	{
+	public:
+		size_t m_begin; // the line, as offsets into the batch text
+		size_t m_end;
+		Game *m_game;
+		std::string m_response; // kept between batches so the buffer is reused
+	};
+
+	// The text of the complete lines read for one batch, and the commands in it
+	class Batch
+	{
+	public:
+		std::vector<char> m_text;
+		std::vector<Command> m_commands; // only the first m_commandCount are in use
+		size_t m_commandCount;
+		std::vector<Game*> m_games; // games with commands in the batch
+	};
+
+	// Each worker thread owns one of these
+	class WorkerState
+	{
+	public:
+		std::string m_word;
+		std::string m_errorText;
+		std::vector<std::string> m_rows;
+	};
+
+	void ReadLoop(); // the reader thread
+	bool ReadBatch(int input, Batch &batch);
+	void PrepareBatch(Batch &batch);
+	void ExecuteBatch(Batch &batch);
+	bool WriteBatch(const Batch &batch, FILE *output);
+	void Execute(const Batch &batch, Command &command, WorkerState &worker);
+
+	std::shared_ptr<const WordValidator> m_validator;
+	std::unordered_map<std::string, std::unique_ptr<Game>> m_games;
+	std::vector<std::unique_ptr<WorkerState>> m_workers;
+	WorkerPool m_pool;
+
+	// The reader thread fills free batches and queues them for Run - two batches, so one is read while the other executes
+	std::thread m_reader;
+	std::mutex m_readLock;
+	std::condition_variable m_readChanged;
+	Batch m_batches[2];
+	std::vector<Batch*> m_freeBatches;
+	std::deque<Batch*> m_readBatches; // read, in order, waiting to execute
+	int m_readInput; // the input of the Run in progress, -1 when none
+	bool m_reading; // the reader is in ReadBatch
+	bool m_readEnded; // the input has ended
+	bool m_shutdown; // the reader thread is to exit
+	std::string m_readError; // set if reading failed
+	std::vector<char> m_readBuffer; // bytes read but not yet part of a batch (an incomplete last line)
+	size_t m_readSize;
+	bool m_inputEnded;
+	std::string m_gameKey;
+	int m_threadCount;
+	int m_batchSize;
+	size_t m_commandCount;
+	size_t m_batchCount;
+	double m_elapsedSeconds;
+};
@@ -0,0 +1,239 @@
+/*
+Single writer / many reader board - see ConcurrentWordBoard.h
+*/
+
+#include "stdafx.h"
+#include "ConcurrentWordBoard.h"
+#include <thread>
+
+ConcurrentWordBoard::ConcurrentWordBoard()
+	: m_width(0)
+	, m_height(0)
+	, m_cellWords(0)
+	, m_sequence(0)
+{
+}
+
+ConcurrentWordBoard::~ConcurrentWordBoard()
+{
+}
+
+bool ConcurrentWordBoard::Init(int width, int height)
+{
+	return m_board.Init(width, height) && Resize();
+}
+
+bool ConcurrentWordBoard::Init(int width, int height, std::shared_ptr<const WordValidator> validator)
+{
+	return m_board.Init(width, height, validator) && Resize();
+}
+
+bool ConcurrentWordBoard::Clear()
+{
+	bool success = m_board.Clear();
+	PublishAll();
+	return success;
+}
+
+bool ConcurrentWordBoard::AddWordH(int row, int col, const std::string &word, std::string &errorText)
+{
+	bool success = m_board.AddWordH(row, col, word, errorText);
+	if (success)
+		PublishMove(*m_board.GetLastMove());
+	return success;
+}
+
+bool ConcurrentWordBoard::AddWordV(int row, int col, const std::string &word, std::string &errorText)
+{
+	bool success = m_board.AddWordV(row, col, word, errorText);
+	if (success)
+		PublishMove(*m_board.GetLastMove());
+	return success;
+}
+
+bool ConcurrentWordBoard::AddWordH(int row, int col, const std::string &word, std::string &errorText, int &score)
+{
+	bool success = m_board.AddWordH(row, col, word, errorText, score);
+	if (success)
+		PublishMove(*m_board.GetLastMove());
+	return success;
+}
+
+bool ConcurrentWordBoard::AddWordV(int row, int col, const std::string &word, std::string &errorText, int &score)
+{
+	bool success = m_board.AddWordV(row, col, word, errorText, score);
+	if (success)
+		PublishMove(*m_board.GetLastMove());
+	return success;
+}
+
+bool ConcurrentWordBoard::Undo(std::string &errorText)
+{
+	bool success = m_board.Undo(errorText);
+	if (success)
+		PublishMove(*m_board.GetLastRedoMove()); // the move just undone
+	return success;
+}
+
+bool ConcurrentWordBoard::Redo(std::string &errorText)
+{
+	bool success = m_board.Redo(errorText);
+	if (success)
+		PublishMove(*m_board.GetLastMove()); // the move just redone
+	return success;
+}
+
+/// <summary>
+/// Sizes the published squares to match the board and publishes all of them.
+/// </summary>
+bool ConcurrentWordBoard::Resize()
+{
+	m_width = m_board.GetNumColumns();
+	m_height = m_board.GetNumRows();
+	m_cellWords = (size_t(m_width) * size_t(m_height) + 7) / 8;
+	m_cells.reset(new std::atomic<uint64_t>[m_cellWords]);
+	for (size_t index = 0; index < m_cellWords; index++)
+		m_cells[index].store(0, std::memory_order_relaxed);
+	PublishAll();
+	return true;
+}
+
+/// <summary>
+/// Copies a run of squares from the writer's board into the packed squares - read straight from the
+/// board storage, with one load and one store per packed word the run touches.
+/// </summary>
+void ConcurrentWordBoard::StoreCells(int row, int col, DirectionType direction, int length)
+{
+	if (length <= 0)
+		return;
+	// Only the writer stores, so a plain load/modify/store of the packed squares is enough
+	const DynamicBoardStorage &squares = m_board.GetStorage();
+	bool horizontal = (dirHorizontal == direction);
+	size_t index = size_t(row) * m_width + col;
+	size_t step = horizontal ? 1 : size_t(m_width);
+	size_t wordIndex = index / 8;
+	uint64_t packed = m_cells[wordIndex].load(std::memory_order_relaxed);
+	for (int nChar = 0; nChar < length; nChar++, index += step)
+	{
+		if (wordIndex != index / 8)
+		{
+			m_cells[wordIndex].store(packed, std::memory_order_relaxed);
+			wordIndex = index / 8;
+			packed = m_cells[wordIndex].load(std::memory_order_relaxed);
+		}
+		char value = horizontal ? squares.Get(row, col + nChar) : squares.Get(row + nChar, col);
+		int shift = int(index % 8) * 8;
+		packed = (packed & ~(uint64_t(0xFF) << shift)) | (uint64_t(uint8_t(value)) << shift);
+	}
+	m_cells[wordIndex].store(packed, std::memory_order_relaxed);
+}
+
+/// <summary>
+/// Publishes every square of the board (after Init/Clear).
+/// </summary>
+void ConcurrentWordBoard::PublishAll()
+{
+	uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+	m_sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	for (int nRow = 0; nRow < m_height; nRow++)
+		StoreCells(nRow, 0, dirHorizontal, m_width);
+	m_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+/// <summary>
+/// Publishes the squares covered by a move that was just applied or undone.
+/// </summary>
+void ConcurrentWordBoard::PublishMove(const WordBoardMove &move)
+{
+	uint64_t sequence = m_sequence.load(std::memory_order_relaxed);
+	m_sequence.store(sequence + 1, std::memory_order_relaxed);
+	std::atomic_thread_fence(std::memory_order_release);
+	StoreCells(move.m_StartRow, move.m_StartCol, move.m_direction, int(move.m_newText.length()));
+	m_sequence.store(sequence + 2, std::memory_order_release);
+}
+
+/// <summary>
+/// Runs copy() until it completes without the writer publishing in the middle of it.
+/// </summary>
+/// <returns>The version that was copied</returns>
+template <class Func>
+uint64_t ConcurrentWordBoard::ReadConsistent(Func copy) const
+{
+	for (int attempt = 0; ; attempt++)
+	{
+		uint64_t before = m_sequence.load(std::memory_order_acquire);
+		if (0 == (before & 1))
+		{
+			copy();
+			std::atomic_thread_fence(std::memory_order_acquire);
+			if (m_sequence.load(std::memory_order_relaxed) == before)
+				return before / 2;
+		}
+		if (attempt >= 16)
+			std::this_thread::yield(); // the writer is busy, give it the core
+	}
+}
+
+/// <summary>
+/// Gets the whole board as of one version.
+/// </summary>
+bool ConcurrentWordBoard::GetBoard(std::vector<std::string> &output, uint64_t *version) const
+{
+	if (0 == m_cellWords)
+		return false;
+	output.resize(m_height);
+	for (auto &row : output)
+		row.resize(m_width);
+	uint64_t read = ReadConsistent([&]()
+	{
+		size_t index = 0;
+		for (int nRow = 0; nRow < m_height; nRow++)
+		{
+			char *cells = &output[nRow][0];
+			for (int nCol = 0; nCol < m_width; nCol++, index++)
+				cells[nCol] = LoadCell(index);
+		}
+	});
+	if (NULL != version)
+		*version = read;
+	return true;
+}
+
+/// <summary>
+/// Gets the squares from row,col to the right for width squares, as of one version.
+/// </summary>
+bool ConcurrentWordBoard::GetBoardTextH(int row, int col, int width, std::string &output, uint64_t *version) const
+{
+	if ((row < 0) || (col < 0) || (width < 0) || (row >= m_height) || ((col + width) > m_width))
+		return false;
+	output.resize(width);
+	size_t first = size_t(row) * m_width + col;
+	uint64_t read = ReadConsistent([&]()
+	{
+		for (int nCol = 0; nCol < width; nCol++)
+			output[nCol] = LoadCell(first + nCol);
+	});
+	if (NULL != version)
+		*version = read;
+	return true;
+}
+
+/// <summary>
+/// Gets the squares from row,col downward for height squares, as of one version.
+/// </summary>
+bool ConcurrentWordBoard::GetBoardTextV(int row, int col, int height, std::string &output, uint64_t *version) const
+{
+	if ((row < 0) || (col < 0) || (height < 0) || (col >= m_width) || ((row + height) > m_height))
+		return false;
+	output.resize(height);
+	size_t first = size_t(row) * m_width + col;
+	uint64_t read = ReadConsistent([&]()
+	{
+		for (int nRow = 0; nRow < height; nRow++)
+			output[nRow] = LoadCell(first + size_t(nRow) * m_width);
+	});
+	if (NULL != version)
+		*version = read;
+	return true;
+}
@@ -0,0 +1,74 @@
+/*
+A WordBoard shared by one writer thread and any number of reader threads.
+
+The writer (AddWordH/AddWordV/Undo/Redo) works on an ordinary WordBoard and then publishes the
+squares the move changed into a mirror of the board guarded by a sequence lock:
+
+	writer:  sequence becomes odd, changed squares are stored, sequence becomes even
+	reader:  read sequence (retry while odd), copy squares, re-read sequence and retry if it moved
+
+Readers never take a lock and never write shared memory, so they do not slow the writer or each
+other, and the writer never waits on readers.  Every read returns the board as it was at one
+version (the number of changes published so far).
+
+The mirror squares are packed 8 to a std::atomic<uint64_t> so the copies are plain (relaxed) atomic
+loads with no data race.  Init changes the board size and must be called before readers start.
+*/
+
+#pragma once
+
+#include "WordBoard.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+class ConcurrentWordBoard
+{
+public:
+	ConcurrentWordBoard();
+	~ConcurrentWordBoard();
+
+	// Writer side - one thread only.  Init must happen before any reader uses the board.
+	bool Init(int width, int height);
+	bool Init(int width, int height, std::shared_ptr<const WordValidator> validator);
+	bool Clear();
+	bool AddWordH(int row, int col, const std::string &word, std::string &errorText);
+	bool AddWordV(int row, int col, const std::string &word, std::string &errorText);
+	bool AddWordH(int row, int col, const std::string &word, std::string &errorText, int &score);
+	bool AddWordV(int row, int col, const std::string &word, std::string &errorText, int &score);
+	bool Undo(std::string &errorText);
+	bool Redo(std::string &errorText);
+	WordBoard &GetWriterBoard() { return m_board; } // direct access for the writer thread (changes are not published)
+
+	// Reader side - any number of threads, lock free.  version (if not NULL) is set to the version read.
+	int GetNumColumns() const { return m_width; }
+	int GetNumRows() const { return m_height; }
+	uint64_t GetVersion() const { return m_sequence.load(std::memory_order_acquire) / 2; }
+	bool GetBoard(std::vector<std::string> &output, uint64_t *version = NULL) const;
+	bool GetBoardTextH(int row, int col, int width, std::string &output, uint64_t *version = NULL) const;
+	bool GetBoardTextV(int row, int col, int height, std::string &output, uint64_t *version = NULL) const;
+
+private:
+	ConcurrentWordBoard(const ConcurrentWordBoard &) = delete;
+	ConcurrentWordBoard &operator=(const ConcurrentWordBoard &) = delete;
+
+	bool Resize();
+	void PublishAll();
+	void PublishMove(const WordBoardMove &move);
+	void StoreCells(int row, int col, DirectionType direction, int length);
+	char LoadCell(size_t index) const
+	{
+		return char(m_cells[index / 8].load(std::memory_order_relaxed) >> ((index % 8) * 8));
+	}
+	template <class Func>
+	uint64_t ReadConsistent(Func copy) const;
+
+	WordBoard m_board; // the writer's board
+	int m_width;
+	int m_height;
+	std::unique_ptr<std::atomic<uint64_t>[]> m_cells; // published squares, row major, 8 per element
+	size_t m_cellWords;
+	std::atomic<uint64_t> m_sequence; // odd while the writer is publishing
+};
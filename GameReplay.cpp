@@ -0,0 +1,313 @@
+/*
+Replays archived game logs - see GameReplay.h for the log format
+*/
+
+#include "stdafx.h"
+#include "GameReplay.h"
+#include "LineParser.h"
+#include "ParallelFor.h"
+#include <chrono>
+#include <algorithm>
+#include <cstring>
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+	: m_data(NULL)
+	, m_size(0)
+#if defined(_WIN32)
+	, m_file(INVALID_HANDLE_VALUE)
+	, m_mapping(NULL)
+#else
+	, m_file(-1)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+/// <summary>
+/// Maps the file read only into memory.  An empty file opens successfully with no data.
+/// </summary>
+/// <param name="filename">The file to map.</param>
+/// <returns>true on success, false on failure</returns>
+bool MappedFile::Open(LPCSTR filename)
+{
+	Close();
+	bool success = false;
+#if defined(_WIN32)
+	m_file = ::CreateFileA(filename, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (INVALID_HANDLE_VALUE != m_file)
+	{
+		LARGE_INTEGER size;
+		if (::GetFileSizeEx(m_file, &size))
+		{
+			m_size = size_t(size.QuadPart);
+			if (0 == m_size)
+				success = true;
+			else
+			{
+				m_mapping = ::CreateFileMappingA(m_file, NULL, PAGE_READONLY, 0, 0, NULL);
+				if (NULL != m_mapping)
+				{
+					m_data = static_cast<const char*>(::MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+					success = (NULL != m_data);
+				}
+			}
+		}
+	}
+#else
+	m_file = ::open(filename, O_RDONLY);
+	if (m_file >= 0)
+	{
+		struct stat info;
+		if (0 == ::fstat(m_file, &info))
+		{
+			m_size = size_t(info.st_size);
+			if (0 == m_size)
+				success = true;
+			else
+			{
+				void *data = ::mmap(NULL, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+				if (MAP_FAILED != data)
+				{
+					::madvise(data, m_size, MADV_SEQUENTIAL);
+					m_data = static_cast<const char*>(data);
+					success = true;
+				}
+			}
+		}
+	}
+#endif
+	if (!success)
+		Close();
+	return success;
+}
+
+void MappedFile::Close()
+{
+#if defined(_WIN32)
+	if (NULL != m_data)
+		::UnmapViewOfFile(m_data);
+	if (NULL != m_mapping)
+		::CloseHandle(m_mapping);
+	if (INVALID_HANDLE_VALUE != m_file)
+		::CloseHandle(m_file);
+	m_mapping = NULL;
+	m_file = INVALID_HANDLE_VALUE;
+#else
+	if (NULL != m_data)
+		::munmap(const_cast<char*>(m_data), m_size);
+	if (m_file >= 0)
+		::close(m_file);
+	m_file = -1;
+#endif
+	m_data = NULL;
+	m_size = 0;
+}
+
+namespace
+{
+	bool IsGameLine(const char *token, int length)
+	{
+		return IsToken(token, length, "GAME");
+	}
+}
+
+GameReplayer::GameReplayer()
+	: m_threadCount(0)
+	, m_batchSize(16)
+	, m_moveCount(0)
+	, m_elapsedSeconds(0.0)
+{
+}
+
+GameReplayer::~GameReplayer()
+{
+}
+
+/// <summary>
+/// Sets the word list used to validate every game.
+/// </summary>
+/// <param name="validator">The loaded word list.</param>
+/// <returns>true on success</returns>
+bool GameReplayer::Initialize(std::shared_ptr<const WordValidator> validator)
+{
+	m_validator = validator;
+	return nullptr != m_validator;
+}
+
+/// <summary>
+/// Maps the log file into memory and indexes where each game starts.
+/// </summary>
+/// <param name="filename">The log file.</param>
+/// <param name="errorText">Set to the reason on failure.</param>
+/// <returns>true on success, false on failure</returns>
+bool GameReplayer::Open(LPCSTR filename, std::string &errorText)
+{
+	m_games.clear();
+	if (!m_log.Open(filename))
+	{
+		errorText = std::string("Unable to open game log: ") + filename;
+		return false;
+	}
+	return IndexGames(errorText);
+}
+
+/// <summary>
+/// Scans the log once recording the extent of each game, so games can be handed out to threads.
+/// </summary>
+bool GameReplayer::IndexGames(std::string &errorText)
+{
+	const char *data = m_log.GetData();
+	size_t size = m_log.GetSize();
+	int line = 0;
+	for (size_t pos = 0; pos < size; )
+	{
+		size_t lineEnd = FindLineEnd(data, pos, size);
+		line++;
+		LineParser parser(data + pos, data + lineEnd);
+		const char *token;
+		int length;
+		if (!parser.IsEmpty() && parser.Token(token, length))
+		{
+			if (IsGameLine(token, length))
+			{
+				if (!m_games.empty())
+					m_games.back().m_end = pos;
+				GameEntry game;
+				game.m_offset = pos;
+				game.m_end = size;
+				game.m_line = line;
+				m_games.push_back(game);
+			}
+			else if (m_games.empty())
+			{
+				errorText = "Move found before the first GAME line at line " + std::to_string(line);
+				return false;
+			}
+		}
+		pos = lineEnd + 1;
+	}
+	return true;
+}
+
+/// <summary>
+/// Replays a single game on the worker's board, stopping at the first move that fails.
+/// </summary>
+void GameReplayer::ReplayGame(const GameEntry &game, WorkerState &worker, GameReplayResult &result) const
+{
+	const char *data = m_log.GetData();
+	result.m_gameId = data + game.m_offset;
+	result.m_gameIdLength = 0;
+	result.m_valid = false;
+	result.m_movesApplied = 0;
+	result.m_failedMove = -1;
+	result.m_failedLine = -1;
+	result.m_errorText.clear();
+
+	// GAME <id> <width> <height>
+	size_t lineEnd = FindLineEnd(data, game.m_offset, game.m_end);
+	LineParser header(data + game.m_offset, data + lineEnd);
+	const char *token;
+	int length;
+	int width = 0;
+	int height = 0;
+	header.Token(token, length);
+	if (!header.Token(result.m_gameId, result.m_gameIdLength) || !header.Number(width) || !header.Number(height) ||
+		!header.AtEnd() || (width <= 0) || (height <= 0) || ((uint64_t(width) * uint64_t(height)) > MaxBoardCells))
+	{
+		result.m_failedLine = game.m_line;
+		result.m_errorText = "Invalid GAME line, expected: GAME <id> <width> <height>";
+		return;
+	}
+
+	// Reuse the worker's board - only resize when the game is a different size
+	WordBoard &board = worker.m_board;
+	bool ready = ((board.GetNumColumns() == width) && (board.GetNumRows() == height)) ? board.Clear() : board.Init(width, height, m_validator);
+	if (!ready)
+	{
+		result.m_failedLine = game.m_line;
+		result.m_errorText = "Unable to initialize the board";
+		return;
+	}
+
+	int line = game.m_line;
+	int move = 0;
+	for (size_t pos = lineEnd + 1; pos < game.m_end; pos = lineEnd + 1, line++)
+	{
+		lineEnd = FindLineEnd(data, pos, game.m_end);
+		LineParser parser(data + pos, data + lineEnd);
+		if (parser.IsEmpty())
+			continue;
+
+		// H|V <row> <col> <WORD>
+		int row = 0;
+		int col = 0;
+		const char *word;
+		int wordLength;
+		bool parsed = parser.Token(token, length) && (1 == length) && (('H' == *token) || ('V' == *token)) &&
+			parser.Number(row) && parser.Number(col) && parser.Token(word, wordLength) && parser.AtEnd();
+		bool accepted = false;
+		if (parsed)
+		{
+			worker.m_word.assign(word, wordLength); // reuses the worker's buffer, no allocation once it has grown
+			if ('H' == *token)
+				accepted = board.AddWordH(row, col, worker.m_word, worker.m_errorText);
+			else
+				accepted = board.AddWordV(row, col, worker.m_word, worker.m_errorText);
+			worker.m_moveCount++;
+		}
+		else
+			worker.m_errorText = "Unable to parse move, expected: H|V <row> <col> <WORD>";
+		if (!accepted)
+		{
+			result.m_failedMove = move;
+			result.m_failedLine = line + 1;
+			result.m_errorText = worker.m_errorText;
+			return;
+		}
+		result.m_movesApplied = ++move;
+	}
+	result.m_valid = true;
+}
+
+/// <summary>
+/// Replays every game in the log using the configured number of threads.
+/// </summary>
+/// <param name="results">Set to one result per game, in the order of the log.</param>
+/// <returns>true if the replay ran (individual games may still be invalid), false if not initialized</returns>
+bool GameReplayer::Replay(std::vector<GameReplayResult> &results)
+{
+	m_moveCount = 0;
+	m_elapsedSeconds = 0.0;
+	if (!m_validator)
+		return false;
+
+	auto start = std::chrono::steady_clock::now();
+	results.resize(m_games.size());
+	int threadCount = GetWorkerThreadCount(m_threadCount);
+	std::vector<std::unique_ptr<WorkerState>> workers(threadCount);
+	for (auto &worker : workers)
+	{
+		worker.reset(new WorkerState());
+		worker->m_moveCount = 0;
+	}
+
+	ParallelFor(m_games.size(), threadCount, size_t(std::max(m_batchSize, 1)), [&](size_t index, int threadIndex)
+	{
+		ReplayGame(m_games[index], *workers[threadIndex], results[index]);
+	});
+
+	for (auto &worker : workers)
+		m_moveCount += worker->m_moveCount;
+	m_elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return true;
+}
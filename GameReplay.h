@@ -0,0 +1,125 @@
+/*
+Replays archived game logs against the word list, many games at a time.
+
+The log is a text file mapped into memory (no copy) holding any number of games:
+
+	# comment lines start with '#'
+	GAME <id> <width> <height>
+	H <row> <col> <WORD>         (AddWordH)
+	V <row> <col> <WORD>         (AddWordV)
+	GAME <id> <width> <height>   (next game starts)
+	...
+
+Games are indexed with one scan of the file and then replayed in parallel.  Each worker thread
+keeps its own WordBoard (sharing one loaded word list) and reuses it for every game it picks up,
+so the dictionary is loaded once and moves are parsed straight out of the mapped file.
+*/
+
+#pragma once
+
+#include "WordBoard.h"
+#include <memory>
+#include <string>
+#include <vector>
+
+/// <summary>
+/// Read only view of a file mapped into memory (MapViewOfFile on Windows, mmap elsewhere)
+/// </summary>
+class MappedFile
+{
+public:
+	MappedFile();
+	~MappedFile();
+
+	bool Open(LPCSTR filename);
+	void Close();
+
+	const char *GetData() const { return m_data; }
+	size_t GetSize() const { return m_size; }
+
+private:
+	MappedFile(const MappedFile &) = delete;
+	MappedFile &operator=(const MappedFile &) = delete;
+
+	const char *m_data;
+	size_t m_size;
+#if defined(_WIN32)
+	HANDLE m_file;
+	HANDLE m_mapping;
+#else
+	int m_file;
+#endif
+};
+
+/// <summary>
+/// The result of replaying one game from the log
+/// </summary>
+class GameReplayResult
+{
+public:
+	std::string GetGameId() const { return std::string(m_gameId, m_gameIdLength); }
+
+	LPCSTR m_gameId; // points into the mapped log (not null terminated)
+	int m_gameIdLength;
+	bool m_valid; // true if every move in the game was accepted
+	int m_movesApplied; // moves accepted before the first failure (or all of them)
+	int m_failedMove; // index (0 based) of the first failing move, -1 if none
+	int m_failedLine; // line number (1 based) in the log of the first failing move, -1 if none
+	std::string m_errorText; // error for the first failing move
+};
+
+/// <summary>
+/// Replays every game in a log in parallel and reports per game validity and throughput
+/// </summary>
+class GameReplayer
+{
+public:
+	GameReplayer();
+	~GameReplayer();
+
+	bool Initialize(std::shared_ptr<const WordValidator> validator); // word list shared by all worker boards
+	bool Open(LPCSTR filename, std::string &errorText); // maps the log and indexes the games in it
+
+	// Tuning - number of worker threads (0 = all hardware threads) and how many games a thread takes at a time
+	void SetThreadCount(int threadCount) { m_threadCount = threadCount; }
+	void SetBatchSize(int batchSize) { m_batchSize = batchSize; }
+
+	bool Replay(std::vector<GameReplayResult> &results); // replays all games, results are in log order
+
+	// Statistics from the last Replay
+	size_t GetGameCount() const { return m_games.size(); }
+	size_t GetMoveCount() const { return m_moveCount; }
+	double GetElapsedSeconds() const { return m_elapsedSeconds; }
+	double GetGamesPerSecond() const { return (m_elapsedSeconds > 0.0) ? double(m_games.size()) / m_elapsedSeconds : 0.0; }
+	double GetMovesPerSecond() const { return (m_elapsedSeconds > 0.0) ? double(m_moveCount) / m_elapsedSeconds : 0.0; }
+
+private:
+	class GameEntry
+	{
+	public:
+		size_t m_offset; // offset of the GAME line in the log
+		size_t m_end; // offset just past the game (start of the next GAME line or end of file)
+		int m_line; // line number of the GAME line
+	};
+
+	// Each worker owns one of these and reuses it for every game it replays
+	class WorkerState
+	{
+	public:
+		WordBoard m_board;
+		std::string m_word;
+		std::string m_errorText;
+		size_t m_moveCount;
+	};
+
+	bool IndexGames(std::string &errorText);
+	void ReplayGame(const GameEntry &game, WorkerState &worker, GameReplayResult &result) const;
+
+	std::shared_ptr<const WordValidator> m_validator;
+	MappedFile m_log;
+	std::vector<GameEntry> m_games;
+	int m_threadCount;
+	int m_batchSize;
+	size_t m_moveCount;
+	double m_elapsedSeconds;
+};
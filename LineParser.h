@@ -0,0 +1,94 @@
+/*
+Helpers for parsing line based text (game logs, driver commands) in place - tokens point into the
+text being parsed, nothing is copied or allocated.
+*/
+
+#pragma once
+
+#include <climits>
+#include <cstring>
+
+/// <summary>
+/// Finds the end of the line starting at pos (the position of the '\n' or end) - memchr is vectorized by the C runtime.
+/// </summary>
+inline size_t FindLineEnd(const char *data, size_t pos, size_t end)
+{
+	if (pos >= end)
+		return end; // nothing to search (data may be null)
+	const char *found = static_cast<const char*>(memchr(data + pos, '\n', end - pos));
+	return (NULL != found) ? size_t(found - data) : end;
+}
+
+/// <summary>
+/// Simple cursor over one line of text, split on spaces/tabs.
+/// </summary>
+class LineParser
+{
+public:
+	LineParser(const char *begin, const char *end)
+		: m_pos(begin)
+		, m_end(end)
+	{
+		while ((m_end > m_pos) && (('\r' == m_end[-1]) || (' ' == m_end[-1]) || ('\t' == m_end[-1])))
+			m_end--; // trim trailing whitespace (and the \r of \r\n line endings)
+		SkipSpaces();
+	}
+
+	bool IsEmpty() const { return (m_pos == m_end) || ('#' == *m_pos); } // blank or comment
+
+	bool Token(const char *&token, int &length)
+	{
+		SkipSpaces();
+		token = m_pos;
+		while ((m_pos < m_end) && (' ' != *m_pos) && ('\t' != *m_pos))
+			m_pos++;
+		length = int(m_pos - token);
+		return length > 0;
+	}
+
+	bool Number(int &value) // false if there are no digits or the number does not fit in an int
+	{
+		SkipSpaces();
+		bool negative = (m_pos < m_end) && ('-' == *m_pos);
+		if (negative)
+			m_pos++;
+		const char *start = m_pos;
+		bool overflow = false;
+		value = 0;
+		while ((m_pos < m_end) && (*m_pos >= '0') && (*m_pos <= '9'))
+		{
+			int digit = *m_pos++ - '0';
+			if (value > ((INT_MAX - digit) / 10))
+				overflow = true; // keep going so the whole token is used up
+			else
+				value = value * 10 + digit;
+		}
+		if (negative)
+			value = -value;
+		return (m_pos > start) && !overflow;
+	}
+
+	bool AtEnd()
+	{
+		SkipSpaces();
+		return m_pos == m_end;
+	}
+
+private:
+	void SkipSpaces()
+	{
+		while ((m_pos < m_end) && ((' ' == *m_pos) || ('\t' == *m_pos)))
+			m_pos++;
+	}
+
+	const char *m_pos;
+	const char *m_end;
+};
+
+/// <summary>
+/// True if the token (not null terminated) is the given keyword.
+/// </summary>
+inline bool IsToken(const char *token, int length, const char *keyword)
+{
+	return (size_t(length) == strlen(keyword)) && (0 == memcmp(token, keyword, length));
+}
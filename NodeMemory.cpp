@@ -0,0 +1,235 @@
+/*
+Memory on large pages and NUMA nodes - see NodeMemory.h
+*/
+
+#include "stdafx.h"
+#include "NodeMemory.h"
+#include <cstdlib>
+#include <vector>
+#if !defined(_WIN32)
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+namespace
+{
+	const size_t HugePageSize = 2 * 1024 * 1024; // transparent huge page size on x64 Linux
+	const int MaxNodes = 64;
+
+	inline size_t RoundUp(size_t size, size_t pageSize)
+	{
+		return ((size + pageSize - 1) / pageSize) * pageSize;
+	}
+
+#if defined(_WIN32)
+	/// <summary>
+	/// Large pages need SeLockMemoryPrivilege enabled in the process token (once granted to the user by
+	/// the "Lock pages in memory" policy).  Tried once.
+	/// </summary>
+	bool EnableLockMemoryPrivilege()
+	{
+		static const bool enabled = []()
+		{
+			HANDLE token;
+			if (!::OpenProcessToken(::GetCurrentProcess(), TOKEN_ADJUST_PRIVILEGES | TOKEN_QUERY, &token))
+				return false;
+			TOKEN_PRIVILEGES privileges;
+			privileges.PrivilegeCount = 1;
+			privileges.Privileges[0].Attributes = SE_PRIVILEGE_ENABLED;
+			bool success = ::LookupPrivilegeValue(NULL, SE_LOCK_MEMORY_NAME, &privileges.Privileges[0].Luid) &&
+				::AdjustTokenPrivileges(token, FALSE, &privileges, 0, NULL, NULL) && (ERROR_SUCCESS == ::GetLastError());
+			::CloseHandle(token);
+			return success;
+		}();
+		return enabled;
+	}
+#elif defined(__linux__)
+	/// <summary>
+	/// The NUMA nodes and which node each processor is on, read once from /sys/devices/system/node
+	/// </summary>
+	class NodeTable
+	{
+	public:
+		NodeTable() : m_nodeCount(1)
+		{
+			char filename[64];
+			char line[4096];
+			for (int node = 0; node < MaxNodes; node++)
+			{
+				snprintf(filename, sizeof(filename), "/sys/devices/system/node/node%d/cpulist", node);
+				FILE *file = fopen(filename, "r");
+				if (NULL == file)
+					continue;
+				m_nodeCount = node + 1;
+				if (NULL != fgets(line, sizeof(line), file))
+				{
+					// a list of processors and ranges, e.g. "0-15,32-47"
+					for (char *pos = line; ('\0' != *pos) && ('\n' != *pos); )
+					{
+						long first = strtol(pos, &pos, 10);
+						long last = ('-' == *pos) ? strtol(pos + 1, &pos, 10) : first;
+						for (long cpu = first; (cpu >= 0) && (cpu <= last); cpu++)
+						{
+							if (m_cpuNodes.size() <= size_t(cpu))
+								m_cpuNodes.resize(size_t(cpu) + 1, 0);
+							m_cpuNodes[size_t(cpu)] = node;
+						}
+						if (',' != *pos)
+							break;
+						pos++;
+					}
+				}
+				fclose(file);
+			}
+		}
+
+		int m_nodeCount;
+		std::vector<int> m_cpuNodes; // node per processor number
+	};
+
+	const NodeTable &GetNodeTable()
+	{
+		static const NodeTable table;
+		return table;
+	}
+#endif
+}
+
+/// <summary>
+/// Gets the number of NUMA nodes.
+/// </summary>
+/// <returns>The number of nodes, 1 if the machine is not NUMA</returns>
+int GetNumaNodeCount()
+{
+#if defined(_WIN32)
+	ULONG highest = 0;
+	return ::GetNumaHighestNodeNumber(&highest) ? int(highest) + 1 : 1;
+#elif defined(__linux__)
+	return GetNodeTable().m_nodeCount;
+#else
+	return 1;
+#endif
+}
+
+/// <summary>
+/// Gets the NUMA node of the processor the calling thread is running on (it may move, so use as a hint).
+/// </summary>
+/// <returns>The node, 0 if it can not be told</returns>
+int GetCurrentNumaNode()
+{
+#if defined(_WIN32)
+	PROCESSOR_NUMBER processor;
+	USHORT node = 0;
+	::GetCurrentProcessorNumberEx(&processor);
+	return ::GetNumaProcessorNodeEx(&processor, &node) ? int(node) : 0;
+#elif defined(__linux__)
+	const NodeTable &table = GetNodeTable();
+	int cpu = sched_getcpu(); // vDSO call, no system call
+	return ((cpu >= 0) && (size_t(cpu) < table.m_cpuNodes.size())) ? table.m_cpuNodes[size_t(cpu)] : 0;
+#else
+	return 0;
+#endif
+}
+
+NodeMemoryBlock::NodeMemoryBlock()
+	: m_data(NULL)
+	, m_size(0)
+	, m_largePages(false)
+	, m_hugePagesRequested(false)
+{
+}
+
+NodeMemoryBlock::~NodeMemoryBlock()
+{
+	Free();
+}
+
+/// <summary>
+/// Allocates the block, on large pages if asked for and available, otherwise on normal pages (on Linux
+/// with transparent huge pages requested for them).
+/// </summary>
+/// <param name="size">The size in bytes.</param>
+/// <param name="node">The NUMA node the memory should be on, -1 for any node.</param>
+/// <param name="largePages">true to use large pages if they are available.</param>
+/// <returns>true on success, false if the memory could not be allocated</returns>
+bool NodeMemoryBlock::Allocate(size_t size, int node, bool largePages)
+{
+	Free();
+	if (0 == size)
+		return false;
+#if defined(_WIN32)
+	DWORD preferred = (node >= 0) ? DWORD(node) : NUMA_NO_PREFERRED_NODE;
+	size_t pageSize = ::GetLargePageMinimum();
+	if (largePages && (pageSize > 0) && EnableLockMemoryPrivilege())
+	{
+		m_size = RoundUp(size, pageSize);
+		m_data = ::VirtualAllocExNuma(::GetCurrentProcess(), NULL, m_size, MEM_RESERVE | MEM_COMMIT | MEM_LARGE_PAGES, PAGE_READWRITE, preferred);
+		m_largePages = (NULL != m_data);
+	}
+	if (NULL == m_data)
+	{
+		m_size = size;
+		m_data = ::VirtualAllocExNuma(::GetCurrentProcess(), NULL, m_size, MEM_RESERVE | MEM_COMMIT, PAGE_READWRITE, preferred);
+	}
+#else
+	m_size = largePages ? RoundUp(size, HugePageSize) : size;
+#if defined(MAP_HUGETLB)
+	if (largePages)
+	{
+		void *data = ::mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+		m_largePages = (MAP_FAILED != data);
+		if (m_largePages)
+			m_data = data;
+	}
+#endif
+	if (NULL == m_data)
+	{
+		void *data = ::mmap(NULL, m_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		if (MAP_FAILED != data)
+		{
+			m_data = data;
+#if defined(MADV_HUGEPAGE)
+			if (largePages)
+				m_hugePagesRequested = (0 == ::madvise(m_data, m_size, MADV_HUGEPAGE));
+#endif
+		}
+	}
+#if defined(__linux__) && defined(SYS_mbind)
+	if ((NULL != m_data) && (node >= 0) && (node < MaxNodes) && (GetNumaNodeCount() > 1))
+	{
+		// Prefer the node for the pages (nothing has touched them yet) - MPOL_PREFERRED, as numaif.h is not always installed
+		const int PreferredPolicy = 1;
+		unsigned long mask[(MaxNodes * 2) / (8 * sizeof(unsigned long))] = {};
+		mask[size_t(node) / (8 * sizeof(unsigned long))] = 1ul << (size_t(node) % (8 * sizeof(unsigned long)));
+		::syscall(SYS_mbind, m_data, m_size, PreferredPolicy, mask, sizeof(mask) * 8, 0);
+	}
+#endif
+#endif
+	if (NULL == m_data)
+	{
+		m_size = 0;
+		m_largePages = false;
+		m_hugePagesRequested = false;
+	}
+	return NULL != m_data;
+}
+
+void NodeMemoryBlock::Free()
+{
+	if (NULL != m_data)
+	{
+#if defined(_WIN32)
+		::VirtualFree(m_data, 0, MEM_RELEASE);
+#else
+		::munmap(m_data, m_size);
+#endif
+	}
+	m_data = NULL;
+	m_size = 0;
+	m_largePages = false;
+	m_hugePagesRequested = false;
+}
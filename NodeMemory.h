@@ -0,0 +1,49 @@
+/*
+Memory for large, read mostly data shared by every thread (the word list) - on large pages and on a
+chosen NUMA node.
+
+Lookups into megabytes of randomly probed data miss the TLB on most probes with normal 4 KB pages;
+with 2 MB pages the whole list needs only a few TLB entries.  On a machine with more than one NUMA
+node, threads reading memory that belongs to another node pay for the remote access, so data can be
+copied to each node and each thread reads the copy on its own node.
+
+Windows uses VirtualAllocExNuma (MEM_LARGE_PAGES needs the "Lock pages in memory" privilege).  Linux
+tries explicit huge pages (MAP_HUGETLB, needs pages reserved in /proc/sys/vm/nr_hugepages), then
+transparent huge pages (madvise), and prefers the node with mbind.  Either way, if large pages are not
+available normal pages are used.  madvise only asks for transparent huge pages - the kernel may or may
+not back the block with them - so that is reported apart from large pages that were actually allocated.
+*/
+
+#pragma once
+
+#include <cstddef>
+
+int GetNumaNodeCount(); // 1 if the machine is not NUMA (or it can not be told)
+int GetCurrentNumaNode(); // the node of the processor the calling thread is running on
+
+/// <summary>
+/// A block of memory, optionally on large pages and on a given NUMA node.  Contents are zero when allocated.
+/// </summary>
+class NodeMemoryBlock
+{
+public:
+	NodeMemoryBlock();
+	~NodeMemoryBlock();
+
+	bool Allocate(size_t size, int node, bool largePages); // node -1 for any node
+	void Free();
+
+	void *GetData() const { return m_data; }
+	size_t GetSize() const { return m_size; }
+	bool IsLargePages() const { return m_largePages; } // true only if allocated on large pages (MEM_LARGE_PAGES / MAP_HUGETLB)
+	bool IsHugePagesRequested() const { return m_hugePagesRequested; } // true if transparent huge pages were asked for instead
+
+private:
+	NodeMemoryBlock(const NodeMemoryBlock &) = delete;
+	NodeMemoryBlock &operator=(const NodeMemoryBlock &) = delete;
+
+	void *m_data;
+	size_t m_size; // size allocated (rounded up to the page size)
+	bool m_largePages;
+	bool m_hugePagesRequested;
+};
@@ -0,0 +1,210 @@
+/*
+Small helper to spread independent work items (games, commands, ...) over a set of worker threads.
+
+Work is handed out in batches from a shared atomic counter, so threads that finish early simply
+pick up the next batch instead of waiting on a fixed partition.
+
+ParallelFor starts and joins its threads on every call, which is fine for long running work (a replay,
+a self play run).  WorkerPool keeps its threads waiting between calls, for callers that run many short
+parallel steps (the command driver runs one per batch of commands).
+*/
+
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// <summary>
+/// Returns the number of worker threads to use - the requested count or, if not specified (0 or less),
+/// the number of hardware threads.
+/// </summary>
+inline int GetWorkerThreadCount(int requested)
+{
+	if (requested > 0)
+		return requested;
+	int hardware = int(std::thread::hardware_concurrency());
+	return (hardware > 0) ? hardware : 1;
+}
+
+/// <summary>
+/// Calls func(index, threadIndex) for every index in [0, count) using threadCount worker threads.
+/// Indices are handed out batchSize at a time.  The calling thread is used as worker 0 so a thread
+/// count of 1 runs everything inline.
+/// </summary>
+/// <param name="count">The number of work items.</param>
+/// <param name="threadCount">The number of threads (0 or less to use all hardware threads).</param>
+/// <param name="batchSize">The number of items a thread takes at a time.</param>
+/// <param name="func">The function to call per item.</param>
+template <class Func>
+void ParallelFor(size_t count, int threadCount, size_t batchSize, Func func)
+{
+	threadCount = GetWorkerThreadCount(threadCount);
+	if (batchSize < 1)
+		batchSize = 1;
+	size_t batches = (count + batchSize - 1) / batchSize;
+	if (size_t(threadCount) > batches)
+		threadCount = int(std::max<size_t>(batches, 1));
+
+	std::atomic<size_t> next(0);
+	auto worker = [&](int threadIndex)
+	{
+		for (;;)
+		{
+			size_t first = next.fetch_add(batchSize);
+			if (first >= count)
+				break;
+			size_t last = std::min(count, first + batchSize);
+			for (size_t index = first; index < last; index++)
+				func(index, threadIndex);
+		}
+	};
+
+	std::vector<std::thread> threads;
+	threads.reserve(threadCount - 1);
+	for (int nThread = 1; nThread < threadCount; nThread++)
+		threads.emplace_back(worker, nThread);
+	worker(0);
+	for (auto &thread : threads)
+		thread.join();
+}
+
+/// <summary>
+/// A fixed set of worker threads, kept alive between calls to Run.  Run works like ParallelFor (the
+/// calling thread is worker 0) but no threads are created or joined per call.  Only one thread may
+/// call Run at a time.
+/// </summary>
+class WorkerPool
+{
+public:
+	WorkerPool()
+		: m_threadCount(1)
+		, m_call(NULL)
+		, m_context(NULL)
+		, m_count(0)
+		, m_batchSize(1)
+		, m_next(0)
+		, m_busy(0)
+		, m_generation(0)
+		, m_stop(false)
+	{
+	}
+
+	~WorkerPool()
+	{
+		Stop();
+	}
+
+	/// <summary>
+	/// Starts the threads (0 or less for all hardware threads) - does nothing if already running that many.
+	/// </summary>
+	void Start(int threadCount)
+	{
+		threadCount = GetWorkerThreadCount(threadCount);
+		if ((threadCount == m_threadCount) && (m_threads.size() == size_t(threadCount - 1)))
+			return;
+		Stop();
+		m_stop = false;
+		m_threadCount = threadCount;
+		for (int nThread = 1; nThread < threadCount; nThread++)
+			m_threads.emplace_back([this, nThread]() { Work(nThread); });
+	}
+
+	void Stop()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			m_stop = true;
+		}
+		m_wake.notify_all();
+		for (auto &thread : m_threads)
+			thread.join();
+		m_threads.clear();
+		m_threadCount = 1;
+	}
+
+	int GetThreadCount() const { return m_threadCount; }
+
+	/// <summary>
+	/// Calls func(index, threadIndex) for every index in [0, count), returning when all are done.
+	/// </summary>
+	template <class Func>
+	void Run(size_t count, size_t batchSize, Func func)
+	{
+		if (m_threads.empty())
+		{
+			for (size_t index = 0; index < count; index++)
+				func(index, 0);
+			return;
+		}
+		{
+			std::lock_guard<std::mutex> lock(m_lock);
+			m_call = [](void *context, size_t index, int threadIndex) { (*static_cast<Func*>(context))(index, threadIndex); };
+			m_context = &func;
+			m_count = count;
+			m_batchSize = std::max<size_t>(batchSize, 1);
+			m_next = 0;
+			m_busy = int(m_threads.size());
+			m_generation++;
+		}
+		m_wake.notify_all();
+		Process(0);
+		std::unique_lock<std::mutex> lock(m_lock);
+		m_done.wait(lock, [this]() { return 0 == m_busy; });
+		m_call = NULL;
+		m_context = NULL;
+	}
+
+private:
+	WorkerPool(const WorkerPool &) = delete;
+	WorkerPool &operator=(const WorkerPool &) = delete;
+
+	void Process(int threadIndex)
+	{
+		for (;;)
+		{
+			size_t first = m_next.fetch_add(m_batchSize);
+			if (first >= m_count)
+				break;
+			size_t last = std::min(m_count, first + m_batchSize);
+			for (size_t index = first; index < last; index++)
+				m_call(m_context, index, threadIndex);
+		}
+	}
+
+	void Work(int threadIndex)
+	{
+		uint64_t seen = 0;
+		std::unique_lock<std::mutex> lock(m_lock);
+		for (;;)
+		{
+			m_wake.wait(lock, [&]() { return m_stop || (seen != m_generation); });
+			if (m_stop)
+				break;
+			seen = m_generation;
+			lock.unlock();
+			Process(threadIndex);
+			lock.lock();
+			if (0 == --m_busy)
+				m_done.notify_one();
+		}
+	}
+
+	int m_threadCount; // including the thread calling Run
+	std::vector<std::thread> m_threads;
+	std::mutex m_lock;
+	std::condition_variable m_wake; // a new Run or Stop
+	std::condition_variable m_done; // every worker has finished the Run
+	void (*m_call)(void *context, size_t index, int threadIndex); // calls the Func passed to Run
+	void *m_context;
+	size_t m_count;
+	size_t m_batchSize;
+	std::atomic<size_t> m_next;
+	int m_busy; // workers still on the current Run
+	uint64_t m_generation; // counts calls to Run
+	bool m_stop;
+};
@@ -0,0 +1,495 @@
+/*
+Self play games - see SelfPlay.h
+*/
+
+#include "stdafx.h"
+#include "SelfPlay.h"
+#include "BinaryStream.h"
+#include "ParallelFor.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstring>
+
+namespace
+{
+	const int RackSize = 7;
+
+	// Tiles in the bag for each letter A-Z (the standard set without the 2 blanks)
+	const int TileCounts[26] = { 9, 2, 2, 4, 12, 2, 3, 2, 9, 1, 1, 4, 2, 6, 8, 2, 1, 6, 4, 6, 4, 2, 2, 1, 2, 1 };
+
+	void FillBag(std::string &bag, SelfPlayRandom &random)
+	{
+		bag.clear();
+		for (int letter = 0; letter < 26; letter++)
+			bag.append(size_t(TileCounts[letter]), char('A' + letter));
+		for (size_t index = bag.length() - 1; index > 0; index--) // Fisher-Yates shuffle
+			std::swap(bag[index], bag[random.Below(uint32_t(index + 1))]);
+	}
+
+	/// <summary>
+	/// Adds the low 'size' bytes of a value to a hash, least significant first, so checksums are the same on any platform.
+	/// </summary>
+	uint64_t HashValue(uint64_t value, int size, uint64_t hash)
+	{
+		char bytes[8];
+		for (int index = 0; index < size; index++)
+			bytes[index] = char(uint8_t(value >> (index * 8)));
+		return HashBytes(bytes, size_t(size), hash);
+	}
+
+	void FillRack(std::string &rack, std::string &bag)
+	{
+		while ((rack.length() < size_t(RackSize)) && !bag.empty())
+		{
+			rack.push_back(bag.back());
+			bag.pop_back();
+		}
+	}
+
+	/// <summary>
+	/// True if the rack holds every letter of the word except one copy of 'skip'.
+	/// </summary>
+	bool RackHasLetters(const int *rackCounts, LPCSTR word, int length, char skip)
+	{
+		int counts[26] = { 0 };
+		for (int index = 0; index < length; index++)
+			counts[word[index] - 'A']++;
+		counts[skip - 'A']--;
+		for (int letter = 0; letter < 26; letter++)
+		{
+			if (counts[letter] > rackCounts[letter])
+				return false;
+		}
+		return true;
+	}
+}
+
+/// <summary>
+/// Indexes every word of 2 to MaxLetters letters (A-Z only) by its key.
+/// </summary>
+/// <param name="validator">The loaded word list.</param>
+/// <returns>true on success, false if no words could be indexed</returns>
+bool SelfPlayLexicon::Build(const WordValidator &validator)
+{
+	std::vector<std::pair<uint64_t, LPCSTR>> keyed;
+	keyed.reserve(validator.GetWordCount());
+	for (size_t index = 0; index < validator.GetWordCount(); index++)
+	{
+		LPCSTR word = validator.GetWord(index);
+		int length = int(strlen(word));
+		bool letters = (length >= 2) && (length <= MaxLetters);
+		for (int nChar = 0; letters && (nChar < length); nChar++)
+			letters = (word[nChar] >= 'A') && (word[nChar] <= 'Z');
+		if (letters)
+			keyed.push_back(std::make_pair(MakeKey(word, length), word));
+	}
+	std::stable_sort(keyed.begin(), keyed.end(), [](const std::pair<uint64_t, LPCSTR> &left, const std::pair<uint64_t, LPCSTR> &right)
+	{
+		return left.first < right.first; // stable, so words keep their sorted order within a key
+	});
+
+	m_words.resize(keyed.size());
+	m_groups.clear();
+	for (size_t index = 0; index < keyed.size(); index++)
+	{
+		m_words[index] = keyed[index].second;
+		auto group = m_groups.insert(std::make_pair(keyed[index].first, std::make_pair(uint32_t(index), uint32_t(0))));
+		group.first->second.second++;
+	}
+	return !m_words.empty();
+}
+
+/// <summary>
+/// Packs the letters, sorted, 5 bits each - so anagrams get the same key.
+/// </summary>
+uint64_t SelfPlayLexicon::MakeKey(const char *letters, int length)
+{
+	char sorted[MaxLetters];
+	for (int index = 0; index < length; index++)
+	{
+		// insertion sort - at most 8 letters
+		int nPos = index;
+		for (; (nPos > 0) && (sorted[nPos - 1] > letters[index]); nPos--)
+			sorted[nPos] = sorted[nPos - 1];
+		sorted[nPos] = letters[index];
+	}
+	uint64_t key = 0;
+	for (int index = 0; index < length; index++)
+		key = (key << 5) | uint64_t(sorted[index] - 'A' + 1);
+	return key;
+}
+
+void SelfPlayLexicon::Find(uint64_t key, const LPCSTR *&words, size_t &count) const
+{
+	auto group = m_groups.find(key);
+	if (group == m_groups.end())
+	{
+		words = NULL;
+		count = 0;
+	}
+	else
+	{
+		words = m_words.data() + group->second.first;
+		count = group->second.second;
+	}
+}
+
+/// <summary>
+/// Makes the distinct sets of tiles that can be taken from the rack (sorted letters, no duplicates).
+/// </summary>
+void SelfPlayMoveGenerator::MakeSubsets(const std::string &rack)
+{
+	m_subsets.clear();
+	int tiles = std::min(int(rack.length()), RackSize);
+	for (int mask = 1; mask < (1 << tiles); mask++)
+	{
+		m_letters.clear();
+		for (int tile = 0; tile < tiles; tile++)
+		{
+			if (0 != (mask & (1 << tile)))
+				m_letters.push_back(rack[tile]);
+		}
+		std::sort(m_letters.begin(), m_letters.end());
+		m_subsets.push_back(m_letters);
+	}
+	std::sort(m_subsets.begin(), m_subsets.end());
+	m_subsets.erase(std::unique(m_subsets.begin(), m_subsets.end()), m_subsets.end());
+}
+
+/// <summary>
+/// Lists every move that places rack tiles to form a word through one letter already on the board (a word
+/// may also cover other letters on the board).  The first move goes horizontally through the centre square.
+/// </summary>
+/// <param name="board">The board - moves are tried with AddWordH/AddWordV and undone.</param>
+/// <param name="rack">The player's tiles.</param>
+/// <param name="moves">Set to the legal moves and their scores, in a repeatable order.</param>
+void SelfPlayMoveGenerator::Generate(WordBoard &board, const std::string &rack, std::vector<SelfPlayMove> &moves)
+{
+	moves.clear();
+	MakeSubsets(rack);
+	for (int &count : m_rackCounts)
+		count = 0;
+	for (char tile : rack)
+		m_rackCounts[tile - 'A']++;
+
+	const DynamicBoardStorage &squares = board.GetStorage();
+	int width = squares.Width();
+	int height = squares.Height();
+	const LPCSTR *words;
+	size_t count;
+	if (!board.HasUndo())
+	{
+		int row = height / 2;
+		int centre = width / 2;
+		for (const std::string &subset : m_subsets)
+		{
+			m_lexicon->Find(SelfPlayLexicon::MakeKey(subset.data(), int(subset.length())), words, count);
+			for (size_t nWord = 0; nWord < count; nWord++)
+			{
+				int length = int(subset.length());
+				for (int col = std::max(0, centre - length + 1); (col <= centre) && ((col + length) <= width); col++)
+					TryWord(board, row, col, dirHorizontal, words[nWord], length, -1, moves);
+			}
+		}
+		return;
+	}
+
+	// The letters on the board, grouped by letter
+	for (auto &anchors : m_anchors)
+		anchors.clear();
+	for (int row = 0; row < height; row++)
+	{
+		for (int col = 0; col < width; col++)
+		{
+			char letter = squares.Get(row, col);
+			if ((letter >= 'A') && (letter <= 'Z'))
+				m_anchors[letter - 'A'].push_back(std::make_pair(row, col));
+		}
+	}
+
+	for (int nLetter = 0; nLetter < 26; nLetter++)
+	{
+		if (m_anchors[nLetter].empty())
+			continue;
+		char letter = char('A' + nLetter);
+		for (const std::string &subset : m_subsets)
+		{
+			if (int(subset.length()) >= SelfPlayLexicon::MaxLetters)
+				continue;
+			m_letters = subset;
+			m_letters.push_back(letter);
+			int length = int(m_letters.length());
+			m_lexicon->Find(SelfPlayLexicon::MakeKey(m_letters.data(), length), words, count);
+			for (size_t nWord = 0; nWord < count; nWord++)
+			{
+				LPCSTR word = words[nWord];
+				for (int anchor = 0; anchor < length; anchor++)
+				{
+					if (letter != word[anchor])
+						continue;
+					for (const auto &square : m_anchors[nLetter])
+					{
+						TryWord(board, square.first, square.second - anchor, dirHorizontal, word, length, anchor, moves);
+						TryWord(board, square.first - anchor, square.second, dirVertical, word, length, anchor, moves);
+					}
+				}
+			}
+		}
+	}
+}
+
+/// <summary>
+/// Adds the move if it fits the letters on the board, is legal and was not already found through another
+/// letter on the board.
+/// </summary>
+/// <param name="anchor">Index in the word of the board letter the move was found through (-1 for the first move).</param>
+void SelfPlayMoveGenerator::TryWord(WordBoard &board, int row, int col, DirectionType direction, LPCSTR word, int length, int anchor, std::vector<SelfPlayMove> &moves)
+{
+	const DynamicBoardStorage &squares = board.GetStorage();
+	bool horizontal = (dirHorizontal == direction);
+	if ((row < 0) || (col < 0) || ((horizontal ? col : row) + length > (horizontal ? squares.Width() : squares.Height())))
+		return;
+	int placed = 0;
+	for (int index = 0; index < length; index++)
+	{
+		char square = horizontal ? squares.Get(row, col + index) : squares.Get(row + index, col);
+		if (' ' == square)
+			placed++;
+		else if (square != word[index])
+			return;
+		else if ((index < anchor) && RackHasLetters(m_rackCounts, word, length, square))
+			return; // also found through this earlier letter
+	}
+	if (0 == placed)
+		return;
+
+	m_word.assign(word, length);
+	PlacementResult result = horizontal ? board.AddWordH(row, col, m_word) : board.AddWordV(row, col, m_word); // no message needed for rejects
+	if (result.IsOk())
+	{
+		board.Undo();
+		moves.resize(moves.size() + 1);
+		SelfPlayMove &move = moves.back();
+		move.m_row = row;
+		move.m_col = col;
+		move.m_direction = direction;
+		move.m_word = m_word;
+		move.m_score = result.m_score;
+	}
+}
+
+bool GreedySelfPlayPolicy::ChooseMove(WordBoard &board, const std::string &rack, SelfPlayMoveGenerator &generator, SelfPlayRandom & /*random*/, SelfPlayMove &move)
+{
+	generator.Generate(board, rack, m_moves);
+	if (m_moves.empty())
+		return false;
+	size_t best = 0;
+	for (size_t index = 1; index < m_moves.size(); index++)
+	{
+		if (m_moves[index].m_score > m_moves[best].m_score)
+			best = index;
+	}
+	move = m_moves[best];
+	return true;
+}
+
+bool RandomSelfPlayPolicy::ChooseMove(WordBoard &board, const std::string &rack, SelfPlayMoveGenerator &generator, SelfPlayRandom &random, SelfPlayMove &move)
+{
+	generator.Generate(board, rack, m_moves);
+	if (m_moves.empty())
+		return false;
+	move = m_moves[random.Below(uint32_t(m_moves.size()))];
+	return true;
+}
+
+SelfPlayer::SelfPlayer()
+	: m_seed(1)
+	, m_players(2)
+	, m_width(15)
+	, m_height(15)
+	, m_threadCount(0)
+	, m_batchSize(4)
+	, m_gameCount(0)
+	, m_elapsedSeconds(0.0)
+	, m_checksum(0)
+{
+}
+
+SelfPlayer::~SelfPlayer()
+{
+}
+
+/// <summary>
+/// Sets the word list and builds the lexicon index used for move generation.
+/// </summary>
+/// <param name="validator">The loaded word list.</param>
+/// <returns>true on success</returns>
+bool SelfPlayer::Initialize(std::shared_ptr<const WordValidator> validator)
+{
+	m_validator = validator;
+	m_lexicon.reset();
+	if (!m_validator)
+		return false;
+	std::shared_ptr<SelfPlayLexicon> lexicon = std::make_shared<SelfPlayLexicon>();
+	if (!lexicon->Build(*m_validator))
+		return false;
+	m_lexicon = lexicon;
+	return true;
+}
+
+bool SelfPlayer::SetPlayerCount(int players)
+{
+	if ((players < 1) || (players > SelfPlayResult::MaxPlayers))
+		return false;
+	m_players = players;
+	return true;
+}
+
+/// <summary>
+/// Plays the games using the configured number of threads.
+/// </summary>
+/// <param name="gameCount">The number of games to play.</param>
+/// <param name="results">Set to one result per game, in game order.</param>
+/// <returns>true on success, false if not initialized or a board could not be set up</returns>
+bool SelfPlayer::Play(size_t gameCount, std::vector<SelfPlayResult> &results)
+{
+	m_gameCount = 0;
+	m_latencies.clear();
+	m_elapsedSeconds = 0.0;
+	m_checksum = 0;
+	if (!m_lexicon)
+		return false;
+
+	auto start = std::chrono::steady_clock::now();
+	results.resize(gameCount);
+	int threadCount = GetWorkerThreadCount(m_threadCount);
+	std::vector<std::unique_ptr<WorkerState>> workers(threadCount);
+	for (auto &worker : workers)
+	{
+		worker.reset(new WorkerState(m_lexicon));
+		if (m_policyFactory)
+			worker->m_policy = m_policyFactory();
+		else
+			worker->m_policy.reset(new GreedySelfPlayPolicy());
+	}
+
+	std::atomic<bool> success(true);
+	ParallelFor(gameCount, threadCount, size_t(std::max(m_batchSize, 1)), [&](size_t index, int threadIndex)
+	{
+		if (!PlayGame(index, *workers[threadIndex], results[index]))
+			success = false;
+	});
+	m_elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	for (auto &worker : workers)
+		m_latencies.insert(m_latencies.end(), worker->m_latencies.begin(), worker->m_latencies.end());
+	std::sort(m_latencies.begin(), m_latencies.end());
+	for (const auto &result : results)
+		m_checksum = HashValue(result.m_hash, 8, m_checksum);
+	m_gameCount = gameCount;
+	return success;
+}
+
+/// <summary>
+/// Gets the time taken to choose and play a move at a percentile of all the moves in the last Play.
+/// </summary>
+/// <param name="percentile">0 for the fastest, 50 for the median, 100 for the slowest.</param>
+/// <returns>The time in microseconds</returns>
+double SelfPlayer::GetMoveLatency(double percentile) const
+{
+	if (m_latencies.empty())
+		return 0.0;
+	double position = std::min(std::max(percentile, 0.0), 100.0) / 100.0 * double(m_latencies.size() - 1);
+	return m_latencies[size_t(position + 0.5)];
+}
+
+/// <summary>
+/// Plays one game to the end on the worker's board.
+/// </summary>
+bool SelfPlayer::PlayGame(size_t index, WorkerState &worker, SelfPlayResult &result) const
+{
+	result.m_moves = 0;
+	result.m_passes = 0;
+	result.m_tilesLeft = 0;
+	result.m_hash = HashBytes(NULL, 0);
+	for (int &score : result.m_scores)
+		score = 0;
+
+	WordBoard &board = worker.m_board;
+	bool ready = ((board.GetNumColumns() == m_width) && (board.GetNumRows() == m_height)) ? board.Clear() : board.Init(m_width, m_height, m_validator);
+	if (!ready)
+		return false;
+
+	SelfPlayRandom random(SelfPlayRandom(m_seed ^ (uint64_t(index) * 0xD1B54A32D192ED03ull)).Next());
+	FillBag(worker.m_bag, random);
+	for (int player = 0; player < m_players; player++)
+	{
+		worker.m_racks[player].clear();
+		FillRack(worker.m_racks[player], worker.m_bag);
+	}
+
+	const WordScorer &scorer = *board.GetScorer();
+	const DynamicBoardStorage &squares = board.GetStorage();
+	SelfPlayMove move;
+	std::string rackLeft;
+	int scoreless = 0;
+	for (int player = 0; ; player = (player + 1) % m_players)
+	{
+		std::string &rack = worker.m_racks[player];
+		auto start = std::chrono::steady_clock::now();
+		bool played = worker.m_policy->ChooseMove(board, rack, worker.m_generator, random, move);
+		int score = 0;
+		if (played)
+		{
+			// Take the tiles for the empty squares the word covers off the rack, then play it
+			bool horizontal = (dirHorizontal == move.m_direction);
+			rackLeft = rack;
+			for (size_t nChar = 0; played && (nChar < move.m_word.length()); nChar++)
+			{
+				int row = move.m_row + (horizontal ? 0 : int(nChar));
+				int col = move.m_col + (horizontal ? int(nChar) : 0);
+				if ((row >= m_height) || (col >= m_width) || (' ' != squares.Get(row, col)))
+					continue;
+				size_t tile = rackLeft.find(move.m_word[nChar]);
+				played = (std::string::npos != tile);
+				if (played)
+					rackLeft.erase(tile, 1);
+			}
+			if (played)
+			{
+				played = horizontal ? board.AddWordH(move.m_row, move.m_col, move.m_word, worker.m_errorText, score) :
+					board.AddWordV(move.m_row, move.m_col, move.m_word, worker.m_errorText, score);
+			}
+		}
+		if (!played)
+		{
+			result.m_passes++;
+			if (++scoreless >= (2 * m_players))
+				break;
+			continue;
+		}
+
+		worker.m_latencies.push_back(float(std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count()));
+		result.m_moves++;
+		result.m_scores[player] += score;
+		int placement[4] = { move.m_row, move.m_col, int(move.m_direction), score };
+		for (int value : placement)
+			result.m_hash = HashValue(uint32_t(value), 4, result.m_hash);
+		result.m_hash = HashBytes(move.m_word.data(), move.m_word.length(), result.m_hash);
+		scoreless = 0;
+		rack = rackLeft;
+		FillRack(rack, worker.m_bag);
+		if (rack.empty())
+			break; // went out with the bag empty
+	}
+
+	// Tiles left on a rack count against the player
+	for (int player = 0; player < m_players; player++)
+	{
+		for (char tile : worker.m_racks[player])
+			result.m_scores[player] -= scorer.GetLetterValue(tile);
+	}
+	result.m_tilesLeft = int(worker.m_bag.length());
+	return true;
+}
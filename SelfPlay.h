@@ -0,0 +1,224 @@
+/*
+Self play - plays many complete games in parallel to tune move policies and to stress the library.
+
+Each game deals racks from a shuffled tile bag (the standard 98 letter tiles, no blanks) to its players,
+who take turns asking a move policy for a word to play.  Played tiles are replaced from the bag.  A game
+ends when a player has used all their tiles and the bag is empty, or when every player has passed twice
+in a row.  Letters left on a rack are taken off the player's score.
+
+Everything random comes from a generator seeded from the run's seed and the game's index, so a run
+plays exactly the same games (and gives the same checksum) whatever the number of threads.
+
+Policies are pluggable - derive from SelfPlayPolicy and pass a factory to SelfPlayer::SetPolicy (each
+worker thread gets its own policy object, so policies may keep state).  SelfPlayMoveGenerator lists the
+legal moves for a rack: words formed from rack tiles through a letter already on the board (or through
+the centre square for the first move), found with an anagram index of the word list.
+
+The generator does not find every legal move - it only enumerates words made of rack tiles plus exactly
+one letter already on the board, anchored through that letter.  Words through two or more board letters
+(extending CAT to CATS) and plays that only hook onto the end of a word are not enumerated.  A rack word
+that crosses its one board letter may also lie alongside other words; those incidental words are checked
+by AddWord and the move is kept if they are valid, but parallel plays are not searched for as such.  The
+scores, game lengths and move rates reported by SelfPlayer are for this subset of moves.
+*/
+
+#pragma once
+
+#include "WordBoard.h"
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+/// <summary>
+/// Small, fast random number generator (splitmix64) - gives the same sequence on every platform and compiler.
+/// </summary>
+class SelfPlayRandom
+{
+public:
+	explicit SelfPlayRandom(uint64_t seed) : m_state(seed) {}
+
+	uint64_t Next()
+	{
+		uint64_t value = (m_state += 0x9E3779B97F4A7C15ull);
+		value = (value ^ (value >> 30)) * 0xBF58476D1CE4E5B9ull;
+		value = (value ^ (value >> 27)) * 0x94D049BB133111EBull;
+		return value ^ (value >> 31);
+	}
+	uint32_t Below(uint32_t limit) { return uint32_t(((Next() >> 32) * limit) >> 32); } // 0 to limit-1
+
+private:
+	uint64_t m_state;
+};
+
+/// <summary>
+/// A move found by SelfPlayMoveGenerator
+/// </summary>
+class SelfPlayMove
+{
+public:
+	int m_row;
+	int m_col;
+	DirectionType m_direction;
+	std::string m_word;
+	int m_score;
+};
+
+/// <summary>
+/// Index of the word list by the letters in each word (in any order), so the words that can be made
+/// from a set of tiles are found with one lookup.  Built once and shared by every thread.
+/// </summary>
+class SelfPlayLexicon
+{
+public:
+	static const int MaxLetters = 8; // a full rack plus one letter on the board
+
+	bool Build(const WordValidator &validator);
+
+	// Key for a set of letters (A-Z, at most MaxLetters) - the same whatever order they are in
+	static uint64_t MakeKey(const char *letters, int length);
+
+	// Words made of exactly the letters with the key - count is 0 if there are none
+	void Find(uint64_t key, const LPCSTR *&words, size_t &count) const;
+
+private:
+	std::vector<LPCSTR> m_words; // grouped by key
+	std::unordered_map<uint64_t, std::pair<uint32_t, uint32_t>> m_groups; // key -> first word, count
+};
+
+/// <summary>
+/// Lists the legal moves for a rack - each worker thread needs its own (it reuses its buffers).
+/// </summary>
+class SelfPlayMoveGenerator
+{
+public:
+	explicit SelfPlayMoveGenerator(std::shared_ptr<const SelfPlayLexicon> lexicon) : m_lexicon(lexicon) {}
+
+	// Sets moves to every legal move with its score.  The board is changed while trying the moves and put back.
+	void Generate(WordBoard &board, const std::string &rack, std::vector<SelfPlayMove> &moves);
+
+private:
+	void MakeSubsets(const std::string &rack);
+	void TryWord(WordBoard &board, int row, int col, DirectionType direction, LPCSTR word, int length, int anchor, std::vector<SelfPlayMove> &moves);
+
+	std::shared_ptr<const SelfPlayLexicon> m_lexicon;
+	std::vector<std::string> m_subsets; // distinct sets of rack tiles, letters sorted
+	int m_rackCounts[26]; // tiles on the rack per letter
+	std::vector<std::pair<int, int>> m_anchors[26]; // squares (row, col) holding each letter
+	std::string m_letters;
+	std::string m_word;
+};
+
+/// <summary>
+/// Chooses the move for a turn - derive from this to plug in a policy
+/// </summary>
+class SelfPlayPolicy
+{
+public:
+	virtual ~SelfPlayPolicy() {}
+
+	// Sets move to the move to play and returns true, or returns false to pass.  The board must be left as it was.
+	virtual bool ChooseMove(WordBoard &board, const std::string &rack, SelfPlayMoveGenerator &generator, SelfPlayRandom &random, SelfPlayMove &move) = 0;
+};
+
+// Plays the highest scoring move (the first found on a tie)
+class GreedySelfPlayPolicy : public SelfPlayPolicy
+{
+public:
+	virtual bool ChooseMove(WordBoard &board, const std::string &rack, SelfPlayMoveGenerator &generator, SelfPlayRandom &random, SelfPlayMove &move);
+
+private:
+	std::vector<SelfPlayMove> m_moves;
+};
+
+// Plays a random legal move
+class RandomSelfPlayPolicy : public SelfPlayPolicy
+{
+public:
+	virtual bool ChooseMove(WordBoard &board, const std::string &rack, SelfPlayMoveGenerator &generator, SelfPlayRandom &random, SelfPlayMove &move);
+
+private:
+	std::vector<SelfPlayMove> m_moves;
+};
+
+/// <summary>
+/// The result of one self play game
+/// </summary>
+class SelfPlayResult
+{
+public:
+	static const int MaxPlayers = 4;
+
+	int m_moves; // words played
+	int m_passes; // turns passed
+	int m_scores[MaxPlayers]; // final score of each player
+	int m_tilesLeft; // tiles still in the bag at the end
+	uint64_t m_hash; // hash of every move played, to compare runs
+};
+
+/// <summary>
+/// Plays games in parallel and reports throughput and per move latency
+/// </summary>
+class SelfPlayer
+{
+public:
+	typedef std::function<std::unique_ptr<SelfPlayPolicy>()> PolicyFactory;
+
+	SelfPlayer();
+	~SelfPlayer();
+
+	bool Initialize(std::shared_ptr<const WordValidator> validator); // builds the lexicon index for move generation
+
+	// Setup - the policy defaults to GreedySelfPlayPolicy, two players on a 15x15 board
+	void SetPolicy(PolicyFactory factory) { m_policyFactory = factory; }
+	void SetSeed(uint64_t seed) { m_seed = seed; }
+	bool SetPlayerCount(int players);
+	void SetBoardSize(int width, int height) { m_width = width; m_height = height; }
+	void SetThreadCount(int threadCount) { m_threadCount = threadCount; }
+	void SetBatchSize(int batchSize) { m_batchSize = batchSize; }
+
+	bool Play(size_t gameCount, std::vector<SelfPlayResult> &results); // results are in game order
+
+	// Statistics from the last Play
+	size_t GetGameCount() const { return m_gameCount; }
+	size_t GetMoveCount() const { return m_latencies.size(); }
+	double GetElapsedSeconds() const { return m_elapsedSeconds; }
+	double GetGamesPerSecond() const { return (m_elapsedSeconds > 0.0) ? double(m_gameCount) / m_elapsedSeconds : 0.0; }
+	double GetMovesPerSecond() const { return (m_elapsedSeconds > 0.0) ? double(m_latencies.size()) / m_elapsedSeconds : 0.0; }
+	double GetMoveLatency(double percentile) const; // microseconds to choose and play a move, percentile 0 to 100
+	uint64_t GetChecksum() const { return m_checksum; } // the same for the same seed and settings
+
+private:
+	// Each worker owns one of these and reuses it for every game it plays
+	class WorkerState
+	{
+	public:
+		WorkerState(std::shared_ptr<const SelfPlayLexicon> lexicon) : m_generator(lexicon) {}
+
+		WordBoard m_board;
+		SelfPlayMoveGenerator m_generator;
+		std::unique_ptr<SelfPlayPolicy> m_policy;
+		std::string m_bag;
+		std::string m_racks[SelfPlayResult::MaxPlayers];
+		std::string m_errorText;
+		std::vector<float> m_latencies; // microseconds per move
+	};
+
+	bool PlayGame(size_t index, WorkerState &worker, SelfPlayResult &result) const;
+
+	std::shared_ptr<const WordValidator> m_validator;
+	std::shared_ptr<const SelfPlayLexicon> m_lexicon;
+	PolicyFactory m_policyFactory;
+	uint64_t m_seed;
+	int m_players;
+	int m_width;
+	int m_height;
+	int m_threadCount;
+	int m_batchSize;
+	size_t m_gameCount;
+	std::vector<float> m_latencies; // sorted, from every worker
+	double m_elapsedSeconds;
+	uint64_t m_checksum;
+};
@@ -1,52 +1,94 @@
 #include "stdafx.h"
 #include "WordBoard.h"
 #include "resource.h"
+#include "BinaryStream.h"
+#include "WordBoardChangeFeed.h"
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstring>
 
-WordBoard::WordBoard()
+template <class Storage>
+BasicWordBoard<Storage>::BasicWordBoard()
+	: m_initialized(false)
 {
 }
 
 
-WordBoard::~WordBoard()
+template <class Storage>
+BasicWordBoard<Storage>::~BasicWordBoard()
 {
 }
 
 /// <summary>
-/// Initializes the board.
+/// Initializes the board.  The word list is only loaded the first time, later calls reuse it.
 /// </summary>
 /// <param name="width">The width of the board.</param>
 /// <param name="height">The height of the board.</param>
 /// <returns>true on success</returns>
-bool WordBoard::Init(int width, int height)
+template <class Storage>
+bool BasicWordBoard<Storage>::Init(int width, int height)
 {
-	m_heightBoard = height;
-	m_widthBoard = width;
-	m_board.resize(height);
-	for (int nRow = 0; nRow < height; nRow++)
+	std::shared_ptr<const WordValidator> validator = m_wordValidator;
+	if (!validator)
 	{
-		m_board[nRow].resize(width, ' '); // resize to proper width and set to empty (' ' space character)
-	}
-	m_redoMoves.clear();
-	m_Moves.clear();
+		std::shared_ptr<WordValidator> loaded = std::make_shared<WordValidator>();
 #if defined(_WIN32)
-	// Built on windows, so uses resource bound into executable
-	m_initialized = m_wordValidator.Initialize(IDR_TEXTFILE1);
+		// Built on windows, so uses resource bound into executable
+		bool loadedOk = loaded->Initialize(IDR_TEXTFILE1);
 #else
-	// Built on other than windows, so loads external text file from file system
-	m_initialized = m_wordValidator.Initialize("./WordList.txt");
+		// Built on other than windows, so loads external text file from file system
+		bool loadedOk = loaded->Initialize("./WordList.txt");
 #endif
+		if (loadedOk)
+			validator = loaded;
+	}
+	return Init(width, height, validator);
+}
+
+/// <summary>
+/// Initializes the board using a word list that has already been loaded (and may be shared with other boards).
+/// </summary>
+/// <param name="width">The width of the board.</param>
+/// <param name="height">The height of the board.</param>
+/// <param name="validator">The loaded word list.</param>
+/// <returns>true on success</returns>
+template <class Storage>
+bool BasicWordBoard<Storage>::Init(int width, int height, std::shared_ptr<const WordValidator> validator)
+{
+	m_wordValidator = validator;
+	m_initialized = m_board.Resize(width, height) && (nullptr != m_wordValidator); // fixed size boards fail if the size differs
+	if (m_initialized)
+		UpdateScorer();
+	return Clear();
+}
+
+/// <summary>
+/// Clears the board to empty (spaces ' ') and empties the undo/redo lists.  The board size and word
+/// list are kept, so a board can be reused for another game without calling Init again.
+/// </summary>
+/// <returns>true on success</returns>
+template <class Storage>
+bool BasicWordBoard<Storage>::Clear()
+{
+	m_board.Fill(' '); // set to empty (' ' space character)
+	ReleaseMoves(m_redoMoves);
+	ReleaseMoves(m_Moves);
+	if (m_changeFeed)
+		m_changeFeed->PublishReset();
 	return m_initialized;
 }
 
-bool WordBoard::GetBoardAt(int row, int col, char &value)
+template <class Storage>
+bool BasicWordBoard<Storage>::GetBoardAt(int row, int col, char &value)
 {
 	bool success = false;
 	if (m_initialized)
 	{
-		if ((row >= 0) && (row < m_heightBoard))
+		if ((row >= 0) && (row < m_board.Height()))
 		{
-			if ((col >= 0) && (col < m_widthBoard))
-				value = m_board.at(row).at(col);
+			if ((col >= 0) && (col < m_board.Width()))
+				value = m_board.Get(row, col);
 		}
 	}
 	return success;
@@ -59,32 +101,33 @@ bool WordBoard::GetBoardAt(int row, int col, char &value)
 /// <param name="row">The row index (0 to height-1).</param>
 /// <param name="output">The output.</param>
 /// <returns></returns>
-bool WordBoard::GetBoardRow(int row, std::string &output)
+template <class Storage>
+bool BasicWordBoard<Storage>::GetBoardRow(int row, std::string &output)
 {
 	bool success = false;
 	if (m_initialized)
 	{
-		if ((row >= 0) && (row < m_heightBoard))
+		if ((row >= 0) && (row < m_board.Height()))
 		{
 			success = true;
-			output.resize(m_widthBoard);
-			for(int nCol = 0; nCol < m_widthBoard; nCol++)
-				output[nCol] = m_board[row][nCol];
+			output.resize(m_board.Width());
+			m_board.ReadH(row, 0, m_board.Width(), &output[0]);
 		}
 	}
 	return success;
 }
 
-bool WordBoard::GetBoardCol(int col, std::string &output) // return the specific col as a string
+template <class Storage>
+bool BasicWordBoard<Storage>::GetBoardCol(int col, std::string &output) // return the specific col as a string
 {
 	bool success = false;
 	if (m_initialized)
 	{
-		if ((col >= 0) && (col < m_heightBoard))
+		if ((col >= 0) && (col < m_board.Width()))
 		{
-			output.resize(m_heightBoard);
-			for (int nRow = 0; nRow < m_heightBoard; nRow++)
-				output[nRow] = m_board[nRow][col];
+			success = true;
+			output.resize(m_board.Height());
+			m_board.ReadV(0, col, m_board.Height(), &output[0]);
 		}
 	}
 	return success;
@@ -95,14 +138,15 @@ bool WordBoard::GetBoardCol(int col, std::string &output) // return the specific
 /// </summary>
 /// <param name="output">vector of rows holding the output.</param>
 /// <returns>true on success</returns>
-bool WordBoard::GetBoard(std::vector<std::string> &output)
+template <class Storage>
+bool BasicWordBoard<Storage>::GetBoard(std::vector<std::string> &output)
 {
 	bool success = false;
 	if (m_initialized)
 	{
 		success = true; // assume success, fail on any failure
-		output.resize(m_heightBoard);
-		for (int nRow = 0; success && (nRow < m_heightBoard); nRow++)
+		output.resize(m_board.Height());
+		for (int nRow = 0; success && (nRow < m_board.Height()); nRow++)
 		{
 			success = GetBoardRow(nRow, output[nRow]);
 		}
@@ -110,42 +154,90 @@ bool WordBoard::GetBoard(std::vector<std::string> &output)
 	return success;
 }
 
-bool WordBoard::GetWordH(int row, int col, std::string &word) // return the word left<->right from this point with spaces breaking words or boundaries
+template <class Storage>
+bool BasicWordBoard<Storage>::GetWordH(int row, int col, std::string &word) // return the word left<->right from this point with spaces breaking words or boundaries
 {
 	bool success = false;
-	if ((row >= 0) && (row < m_heightBoard) && (col >= 0) && (col < m_widthBoard))
-	{
-		std::string line;
-		GetBoardRow(row, line);
-		int left = col;
-		while ((left > 0) && (' ' != m_board[row][left-1]))
-			left--; // move to the leftmost non space or index 0 (left boundary)
-		int right = col;
-		while ((right < (m_widthBoard-1)) && (' ' != m_board[row][right+1]))
-			right++;
-		word = line.substr(left, right - left + 1);
+	if ((row >= 0) && (row < m_board.Height()) && (col >= 0) && (col < m_board.Width()))
+	{
+		int length = GetWordSpan(row, col, dirHorizontal);
+		success = GetBoardTextH(row, col, length, word);
 	}
 	return success;
 }
 
-bool WordBoard::GetWordV(int row, int col, std::string &word) // return the word top<->bottom from this point with spaces breaking words or boundaries
+template <class Storage>
+bool BasicWordBoard<Storage>::GetWordV(int row, int col, std::string &word) // return the word top<->bottom from this point with spaces breaking words or boundaries
 {
 	bool success = false;
-	if ((row >= 0) && (row < m_heightBoard) && (col >= 0) && (col < m_widthBoard))
-	{
-		std::string line;
-		GetBoardCol(col, line);
-		int top = row;
-		while ((top > 0) && (' ' != m_board[top-1][col]))
-			top--; // move to the topmost non space or index 0 (top boundary)
-		int bottom = row;
-		while ((bottom < (m_heightBoard - 1)) && (' ' != m_board[bottom+1][col]))
-			bottom++;
-		word = line.substr(top, bottom - top + 1);
+	if ((row >= 0) && (row < m_board.Height()) && (col >= 0) && (col < m_board.Width()))
+	{
+		int length = GetWordSpan(row, col, dirVertical);
+		success = GetBoardTextV(row, col, length, word);
 	}
 	return success;
 }
 
+/// <summary>
+/// Finds the word through a square - the run of letters either side of it, with spaces or the edge of the board ending it.
+/// </summary>
+/// <param name="row">The row, moved to the first square of the word.</param>
+/// <param name="col">The col, moved to the first square of the word.</param>
+/// <param name="direction">The direction of the word.</param>
+/// <returns>The length of the word</returns>
+template <class Storage>
+int BasicWordBoard<Storage>::GetWordSpan(int &row, int &col, DirectionType direction) const
+{
+	int rowStep = (dirHorizontal == direction) ? 0 : 1;
+	int colStep = 1 - rowStep;
+	while ((row >= rowStep) && (col >= colStep) && (' ' != m_board.Get(row - rowStep, col - colStep)))
+	{
+		row -= rowStep; // move to the first non space or index 0 (left/top boundary)
+		col -= colStep;
+	}
+	int length = 1;
+	while (((row + rowStep * length) < m_board.Height()) && ((col + colStep * length) < m_board.Width()) &&
+		(' ' != m_board.Get(row + rowStep * length, col + colStep * length)))
+		length++;
+	return length;
+}
+
+/// <summary>
+/// Checks the word on the board is in the word list, setting the result to the failure and the word's span if not.
+/// </summary>
+/// <returns>true if the word is valid</returns>
+template <class Storage>
+bool BasicWordBoard<Storage>::CheckWord(int row, int col, DirectionType direction, int length, PlacementCode failure, PlacementResult &result)
+{
+	if (dirHorizontal == direction)
+		GetBoardTextH(row, col, length, m_wordText);
+	else
+		GetBoardTextV(row, col, length, m_wordText);
+	if (m_wordValidator->isValid(m_wordText))
+		return true;
+	result.m_code = failure;
+	result.m_row = row;
+	result.m_col = col;
+	result.m_direction = direction;
+	result.m_length = length;
+	return false;
+}
+
+namespace
+{
+	PlacementResult MakePlacementResult(PlacementCode code, int row, int col, DirectionType direction, int length)
+	{
+		PlacementResult result;
+		result.m_code = code;
+		result.m_score = 0;
+		result.m_row = result.m_moveRow = row;
+		result.m_col = result.m_moveCol = col;
+		result.m_direction = result.m_moveDirection = direction;
+		result.m_length = length;
+		return result;
+	}
+}
+
 /// <summary>
 /// Adds the word to the board.
 ///   Will: match against any existing words
@@ -158,181 +250,354 @@ bool WordBoard::GetWordV(int row, int col, std::string &word) // return the word
 /// <param name="word">The word.</param>
 /// <param name="errorText">The error text.</param>
 /// <returns></returns>
-bool WordBoard::AddWordH(int row, int col, const std::string &word, std::string & errorText)
+template <class Storage>
+bool BasicWordBoard<Storage>::AddWordH(int row, int col, const std::string &word, std::string & errorText)
 {
-	bool success = false;
-	if ((row >= 0) && (row < m_heightBoard) && (col >= 0) && (col < m_widthBoard))
+	PlacementResult result = AddWord(row, col, dirHorizontal, word);
+	if (!result.IsOk())
+		GetResultText(result, word, errorText);
+	return result.IsOk();
+}
+
+template <class Storage>
+bool BasicWordBoard<Storage>::AddWordV(int row, int col, const std::string &word, std::string & errorText)
+{
+	PlacementResult result = AddWord(row, col, dirVertical, word);
+	if (!result.IsOk())
+		GetResultText(result, word, errorText);
+	return result.IsOk();
+}
+
+template <class Storage>
+bool BasicWordBoard<Storage>::AddWordH(int row, int col, const std::string &word, std::string & errorText, int &score)
+{
+	PlacementResult result = AddWord(row, col, dirHorizontal, word);
+	if (result.IsOk())
+		score = result.m_score;
+	else
+		GetResultText(result, word, errorText);
+	return result.IsOk();
+}
+
+template <class Storage>
+bool BasicWordBoard<Storage>::AddWordV(int row, int col, const std::string &word, std::string & errorText, int &score)
+{
+	PlacementResult result = AddWord(row, col, dirVertical, word);
+	if (result.IsOk())
+		score = result.m_score;
+	else
+		GetResultText(result, word, errorText);
+	return result.IsOk();
+}
+
+template <class Storage>
+PlacementResult BasicWordBoard<Storage>::AddWordH(int row, int col, const std::string &word)
+{
+	return AddWord(row, col, dirHorizontal, word);
+}
+
+template <class Storage>
+PlacementResult BasicWordBoard<Storage>::AddWordV(int row, int col, const std::string &word)
+{
+	return AddWord(row, col, dirVertical, word);
+}
+
+/// <summary>
+/// Adds the word to the board in either direction - rejects it if it would replace a letter on the board,
+/// otherwise applies the move, checks the main word and every cross word it forms and undoes the move if
+/// any are not valid.  On success the move is scored.
+/// </summary>
+/// <param name="row">The row.</param>
+/// <param name="col">The col.</param>
+/// <param name="direction">The direction of the word.</param>
+/// <param name="word">The word.</param>
+/// <returns>The result - placeOk and the score on success, otherwise the reason and the word at fault</returns>
+template <class Storage>
+PlacementResult BasicWordBoard<Storage>::AddWord(int row, int col, DirectionType direction, const std::string &word)
+{
+	bool horizontal = (dirHorizontal == direction);
+	int length = int(word.length());
+	PlacementResult result = MakePlacementResult(placeOk, row, col, direction, length);
+	if (!m_initialized)
+		result.m_code = placeNotInitialized;
+	else if ((row < 0) || (row >= m_board.Height()) || (col < 0) || (col >= m_board.Width()))
+		result.m_code = placeOutsideBoard;
+	else if (((horizontal ? col : row) + length) > (horizontal ? m_board.Width() : m_board.Height()))
+		result.m_code = placeBeyondEdge;
+	else
 	{
-		int endPos = col + int(word.length()) - 1;
-		if (endPos < m_widthBoard)
+		// Letters already on the board can be played through (in either case, as words are) but not replaced
+		for (int index = 0; index < length; index++)
 		{
-			// Create a move, apply it and then check if valid and undo if needed
-			WordBoardMove move;
-			move.m_direction = dirHorizontal;
-			move.m_StartRow = row;
-			move.m_StartCol = col;
-			move.m_newText = word;
-			GetBoardTextH(row, col, int(word.length()), move.m_originalText);
-			SetBoardTextH(row, col, move.m_newText);
-
-			// Ok, now we have a potentially valid placement - need to check if it works with others
-			if (m_Moves.empty())
+			int nRow = horizontal ? row : row + index;
+			int nCol = horizontal ? col + index : col;
+			char square = m_board.Get(nRow, nCol);
+			if ((' ' != square) && (toupper((unsigned char)square) != toupper((unsigned char)word[index])))
 			{
-				// it is valid because it is the first on the board
-				if (m_wordValidator.isValid(word))
-				{
-					m_Moves.push_back(move);
-					success = true;
-				}
+				// the square at fault, the move itself is kept in m_moveRow/m_moveCol
+				result.m_code = placeLetterConflict;
+				result.m_row = nRow;
+				result.m_col = nCol;
+				result.m_length = 1;
+				return result;
 			}
-			else
+		}
+
+		// Create a move (from the pool of records), apply it and then check if valid and undo if needed
+		bool firstMove = m_Moves.empty();
+		if (m_freeMoves.empty())
+			m_freeMoves.emplace_back();
+		m_Moves.push_back(std::move(m_freeMoves.back()));
+		m_freeMoves.pop_back();
+		WordBoardMove &move = m_Moves.back();
+		move.m_direction = direction;
+		move.m_StartRow = row;
+		move.m_StartCol = col;
+		move.m_newText.assign(word); // reuses the record's buffers
+		if (horizontal)
+			GetBoardTextH(row, col, length, move.m_originalText);
+		else
+			GetBoardTextV(row, col, length, move.m_originalText);
+		ApplyMove(move);
+
+		// Ok, now we have a potentially valid placement - need to check if it works with others
+		if (firstMove)
+		{
+			// it is valid because it is the first on the board
+			if (!m_wordValidator->isValid(word))
+				result.m_code = placeInvalidWord;
+		}
+		else
+		{
+			bool extraMatch = false;
+			DirectionType crossDirection = horizontal ? dirVertical : dirHorizontal;
+			// Check the cross words - formed where there are letters either side of the word (above/below or left/right)
+			for (int index = 0; result.IsOk() && (index < length); index++)
 			{
-				bool extraMatch = false;
-				success = true; // Assume it is true and find out if it is NOT (then undo)
-				bool isValid = true;
-				std::string above(m_widthBoard, ' ');
-				std::string below(m_widthBoard, ' ');
-				if (row > 0) // check the row above (if there is one)
-					GetBoardTextH(row - 1, col, int(word.length()), above);
-				if (row < (m_heightBoard - 1))
-					GetBoardTextH(row + 1, col, int(word.length()), below);
-				// Check the vertical 'words'
-				for (int nCol = 0; success && (nCol < int(word.length())); nCol++)
+				int nRow = horizontal ? row : row + index;
+				int nCol = horizontal ? col + index : col;
+				bool before = horizontal ? ((nRow > 0) && (' ' != m_board.Get(nRow - 1, nCol))) : ((nCol > 0) && (' ' != m_board.Get(nRow, nCol - 1)));
+				bool after = horizontal ? ((nRow < (m_board.Height() - 1)) && (' ' != m_board.Get(nRow + 1, nCol))) : ((nCol < (m_board.Width() - 1)) && (' ' != m_board.Get(nRow, nCol + 1)));
+				if (before || after)
 				{
-					if ((' ' != above[nCol]) || (' ' != below[nCol]))
-					{
-						extraMatch = true;
-						std::string vText;
-						if (GetWordV(row, nCol, vText))
-						{
-							success = m_wordValidator.isValid(vText);
-							if (!success)
-								errorText = "Invalid Vertical match of word: " + vText;
-						}
-					}
-				}
-				if (success)
-				{
-					// Passed vertical words, so check left and right extensions
-					std::string hText;
-					GetWordH(row, col, hText);
-					if (hText.length() != word.length())
-						extraMatch = true;
-					success = m_wordValidator.isValid(hText);
-					if (!success)
-						errorText = "Invalid Horizontal match of word: " + hText;
-				}
-				if (success)
-				{
-					if (extraMatch)
-						m_Moves.push_back(move);
-					else
-					{
-						success = false;
-						errorText = "Moves beyond the first must 'attach' to existing text";
-						UndoMove(move);
-					}
-				}
-				else
-				{
-					// We have a failure, so do the undo!
-					UndoMove(move);
+					extraMatch = true;
+					int crossLength = GetWordSpan(nRow, nCol, crossDirection);
+					CheckWord(nRow, nCol, crossDirection, crossLength, placeInvalidCrossWord, result);
 				}
 			}
+			if (result.IsOk())
+			{
+				// Passed cross words, so check the word with any extensions at either end
+				int mainRow = row;
+				int mainCol = col;
+				int mainLength = GetWordSpan(mainRow, mainCol, direction);
+				if (mainLength != length)
+					extraMatch = true;
+				CheckWord(mainRow, mainCol, direction, mainLength, placeInvalidMainWord, result);
+			}
+			if (result.IsOk() && !extraMatch)
+				result.m_code = placeNotAttached;
+		}
+		if (result.IsOk())
+		{
+			result.m_score = ScorePlacement(row, col, direction, word.data(), move.m_originalText.data(), length);
+			ReleaseMoves(m_redoMoves); // a new move replaces anything that was undone
+			if (m_changeFeed)
+				m_changeFeed->PublishMove(changeAdd, move);
 		}
 		else
-			errorText = "Word would go beyond right edge of board";
+		{
+			// We have a failure, so do the undo!
+			UndoMove(move);
+			m_freeMoves.push_back(std::move(move));
+			m_Moves.pop_back();
+		}
 	}
-	else
-		errorText = "Specied row/col position is outside the bounds of the board";
-	return success;
+	return result;
 }
 
-bool WordBoard::AddWordV(int row, int col, const std::string &word, std::string & errorText)
+/// <summary>
+/// Makes the message for a failed AddWordH/AddWordV/Undo/Redo.  The board must not have been changed since.
+/// </summary>
+/// <param name="result">The result.</param>
+/// <param name="word">The word that was being placed (not used for undo/redo).</param>
+/// <param name="text">Set to the message (empty on success).</param>
+template <class Storage>
+void BasicWordBoard<Storage>::GetResultText(const PlacementResult &result, const std::string &word, std::string &text) const
 {
-	bool success = false;
-	if ((row >= 0) && (row < m_heightBoard) && (col >= 0) && (col < m_widthBoard))
+	bool horizontal = (dirHorizontal == result.m_moveDirection);
+	switch (result.m_code)
 	{
-		int endPos = row + int(word.length()) - 1;
-		if (endPos < m_heightBoard)
+	case placeOk:
+		text.clear();
+		break;
+	case placeNotInitialized:
+		text = "Board is not initialized";
+		break;
+	case placeOutsideBoard:
+		text = "Specied row/col position is outside the bounds of the board";
+		break;
+	case placeBeyondEdge:
+		text = horizontal ? "Word would go beyond right edge of board" : "Word would go beyond bottom edge of board";
+		break;
+	case placeLetterConflict:
+		text.assign("Word does not match the letter ").append(1, m_board.Get(result.m_row, result.m_col)).append(" already on the board at ").append(std::to_string(result.m_row)).append(",").append(std::to_string(result.m_col));
+		break;
+	case placeInvalidWord:
+		text.assign("Invalid word: ").append(word);
+		break;
+	case placeInvalidCrossWord:
+	case placeInvalidMainWord:
+		text.assign((dirHorizontal == result.m_direction) ? "Invalid Horizontal match of word: " : "Invalid Vertical match of word: ");
+		for (int index = 0; index < result.m_length; index++)
 		{
-			// Create a move, apply it and then check if valid and undo if needed
-			WordBoardMove move;
-			move.m_direction = dirVertical;
-			move.m_StartRow = row;
-			move.m_StartCol = col;
-			move.m_newText = word;
-			GetBoardTextV(row, col, int(word.length()), move.m_originalText);
-			SetBoardTextV(row, col, move.m_newText);
-
-			// Ok, now we have a potentially valid placement - need to check if it works with others
-			if (m_Moves.empty())
-			{
-				// it is valid because it is the first on the board
-				m_Moves.push_back(move);
-				success = true;
-			}
-			else
-			{
-				bool extraMatch = false;
-				success = true; // Assume it is true and find out if it is NOT (then undo)
-				bool isValid = true;
-				std::string left(m_heightBoard, ' ');
-				std::string right(m_heightBoard, ' ');
-				if (col > 0) // check the row above (if there is one)
-					GetBoardTextV(row, col-1, int(word.length()), left);
-				if (col < (m_widthBoard - 1))
-					GetBoardTextH(row + 1, col, int(word.length()), right);
-				// Check the vertical 'words'
-				for (int nCol = 0; success && (nCol < int(word.length())); nCol++)
-				{
-					if ((' ' != left[nCol]) || (' ' != right[nCol]))
-					{
-						extraMatch = true;
-						std::string hText;
-						if (GetWordH(row, nCol, hText))
-						{
-							success = m_wordValidator.isValid(hText);
-							if (!success)
-								errorText = "Invalid Vertical match of word: " + hText;
-						}
-					}
-				}
-				if (success)
-				{
-					// Passed horizontal words, so check above / below possible extensions
-					std::string vText;
-					GetWordV(row, col, vText);
-					if (vText.length() != word.length())
-						extraMatch = true;
-					success = m_wordValidator.isValid(vText);
-					if (!success)
-						errorText = "Invalid Vertical match of word: " + vText;
-				}
-				if (success)
-				{
-					if (extraMatch)
-						m_Moves.push_back(move);
-					else
-					{
-						success = false;
-						errorText = "Moves beyond the first must 'attach' to existing text";
-						UndoMove(move);
-					}
-				}
-				else
-				{
-					// We have a failure, so do the undo!
-					UndoMove(move);
-				}
-			}
+			// The failed move was taken back off the board, so its letters come from the word
+			int nRow = result.m_row + ((dirHorizontal == result.m_direction) ? 0 : index);
+			int nCol = result.m_col + ((dirHorizontal == result.m_direction) ? index : 0);
+			int offset = horizontal ? (nCol - result.m_moveCol) : (nRow - result.m_moveRow);
+			bool placed = (horizontal ? (nRow == result.m_moveRow) : (nCol == result.m_moveCol)) && (offset >= 0) && (offset < int(word.length()));
+			text += placed ? word[offset] : m_board.Get(nRow, nCol);
 		}
-		else
-			errorText = "Word would go beyond bottom edge of board";
+		break;
+	case placeNotAttached:
+		text = "Moves beyond the first must 'attach' to existing text";
+		break;
+	case placeNothingToUndo:
+		text = "Undo list is empty, nothing to undo";
+		break;
+	case placeNothingToRedo:
+		text = "Redo list is empty, nothing to redo";
+		break;
+	case placeUndoFailed:
+		text = "Error undoing the move";
+		break;
+	case placeRedoFailed:
+		text = "Error redoing the move";
+		break;
 	}
-	else
-		errorText = "Specied row/col position is outside the bounds of the board";
-	return success;
+}
+
+/// <summary>
+/// Scores a word placed at row,col - the main word (including letters already on the board at either
+/// end) plus the cross word through every newly placed letter.  The squares under the placement are
+/// taken from 'letters' and everything else from the board, so this works before or after the move is
+/// applied.  Premiums only count for newly placed letters (squares that were empty in 'original').
+/// </summary>
+/// <param name="row">The row.</param>
+/// <param name="col">The col.</param>
+/// <param name="direction">The direction of the word.</param>
+/// <param name="letters">The letters placed.</param>
+/// <param name="original">What was on the board under the placement, NULL to read it from the board.</param>
+/// <param name="length">The number of letters.</param>
+/// <returns>The score</returns>
+template <class Storage>
+int BasicWordBoard<Storage>::ScorePlacement(int row, int col, DirectionType direction, const char *letters, const char *original, int length) const
+{
+	const WordScorer &scorer = *m_scorer;
+	bool horizontal = (dirHorizontal == direction);
+	int rowStep = horizontal ? 0 : 1;
+	int colStep = horizontal ? 1 : 0;
+
+	// Existing letters extending the main word before and after the placement
+	int mainSum = 0;
+	for (int nRow = row - rowStep, nCol = col - colStep; (nRow >= 0) && (nCol >= 0) && (' ' != m_board.Get(nRow, nCol)); nRow -= rowStep, nCol -= colStep)
+		mainSum += scorer.GetLetterValue(m_board.Get(nRow, nCol));
+	for (int nRow = row + rowStep * length, nCol = col + colStep * length; (nRow < m_board.Height()) && (nCol < m_board.Width()) && (' ' != m_board.Get(nRow, nCol)); nRow += rowStep, nCol += colStep)
+		mainSum += scorer.GetLetterValue(m_board.Get(nRow, nCol));
+
+	int mainMultiplier = 1;
+	int crossTotal = 0;
+	int placed = 0;
+	for (int index = 0, nRow = row, nCol = col; index < length; index++, nRow += rowStep, nCol += colStep)
+	{
+		int value = scorer.GetLetterValue(letters[index]);
+		char was = (NULL != original) ? original[index] : m_board.Get(nRow, nCol);
+		if (' ' != was)
+		{
+			mainSum += value; // letter already on the board, no premium
+			continue;
+		}
+		placed++;
+		int letterMultiplier = scorer.GetLetterMultiplier(nRow, nCol);
+		int wordMultiplier = scorer.GetWordMultiplier(nRow, nCol);
+		mainSum += value * letterMultiplier;
+		mainMultiplier *= wordMultiplier;
+
+		// Cross word through this letter (perpendicular to the placement)
+		int crossSum = 0;
+		bool cross = false;
+		for (int r = nRow - colStep, c = nCol - rowStep; (r >= 0) && (c >= 0) && (' ' != m_board.Get(r, c)); r -= colStep, c -= rowStep, cross = true)
+			crossSum += scorer.GetLetterValue(m_board.Get(r, c));
+		for (int r = nRow + colStep, c = nCol + rowStep; (r < m_board.Height()) && (c < m_board.Width()) && (' ' != m_board.Get(r, c)); r += colStep, c += rowStep, cross = true)
+			crossSum += scorer.GetLetterValue(m_board.Get(r, c));
+		if (cross)
+			crossTotal += (crossSum + value * letterMultiplier) * wordMultiplier;
+	}
+	int score = mainSum * mainMultiplier + crossTotal;
+	if (placed >= scorer.GetBingoTiles())
+		score += scorer.GetBingoBonus();
+	return score;
+}
+
+/// <summary>
+/// Scores candidate moves against the current board without changing it, one after another (the words
+/// are not validated - use AddWordH/AddWordV for that).  Scoring only reads the board and the scorer's
+/// tables, so callers with many candidates can split them across threads.
+/// </summary>
+/// <param name="candidates">The candidate moves.</param>
+/// <param name="scores">Set to the score of each candidate, -1 if it does not fit on the board.</param>
+/// <returns>true on success, false if the board is not initialized</returns>
+template <class Storage>
+bool BasicWordBoard<Storage>::ScoreMoves(const std::vector<WordBoardCandidate> &candidates, std::vector<int> &scores) const
+{
+	scores.resize(candidates.size());
+	if (!m_initialized)
+		return false;
+	for (size_t index = 0; index < candidates.size(); index++)
+	{
+		const WordBoardCandidate &candidate = candidates[index];
+		int length = int(candidate.m_word.length());
+		bool horizontal = (dirHorizontal == candidate.m_direction);
+		bool fits = (candidate.m_row >= 0) && (candidate.m_col >= 0) && (length > 0) &&
+			((horizontal ? candidate.m_col : candidate.m_row) + length <= (horizontal ? m_board.Width() : m_board.Height())) &&
+			((horizontal ? candidate.m_row : candidate.m_col) < (horizontal ? m_board.Height() : m_board.Width()));
+		scores[index] = fits ? ScorePlacement(candidate.m_row, candidate.m_col, candidate.m_direction, candidate.m_word.data(), NULL, length) : -1;
+	}
+	return true;
+}
+
+/// <summary>
+/// Sets the letter values and premium layout used to score moves - it must be the same size as the board.
+/// </summary>
+/// <param name="scorer">The scorer.</param>
+/// <returns>true on success, false if the size does not match the board</returns>
+template <class Storage>
+bool BasicWordBoard<Storage>::SetScorer(std::shared_ptr<const WordScorer> scorer)
+{
+	if (!scorer || (scorer->GetWidth() != m_board.Width()) || (scorer->GetHeight() != m_board.Height()))
+		return false;
+	m_scorer = scorer;
+	return true;
+}
+
+/// <summary>
+/// Sets the feed that adds, undos, redos and resets are published to (NULL to stop publishing).
+/// </summary>
+/// <param name="changeFeed">The change feed.</param>
+template <class Storage>
+void BasicWordBoard<Storage>::SetChangeFeed(std::shared_ptr<WordBoardChangeFeed> changeFeed)
+{
+	m_changeFeed = changeFeed;
+}
+
+/// <summary>
+/// Makes sure there is a scorer matching the board size, creating the default one if needed.
+/// </summary>
+template <class Storage>
+void BasicWordBoard<Storage>::UpdateScorer()
+{
+	if (!m_scorer || (m_scorer->GetWidth() != m_board.Width()) || (m_scorer->GetHeight() != m_board.Height()))
+		m_scorer = WordScorer::GetStandard(m_board.Width(), m_board.Height()); // shared by boards of this size
 }
 
 /// <summary>
@@ -343,19 +608,43 @@ bool WordBoard::AddWordV(int row, int col, const std::string &word, std::string
 /// <param name="width">The width.</param>
 /// <param name="output">The output.</param>
 /// <returns></returns>
-bool WordBoard::GetBoardTextH(int row, int col, int width, std::string &output)
+template <class Storage>
+bool BasicWordBoard<Storage>::GetBoardTextH(int row, int col, int width, std::string &output)
 {
-	bool success;
-	if ((row >= 0) && (col >= 0) && (row < m_heightBoard) && ((col+width) <= m_widthBoard))
+	bool success = false;
+	if ((row >= 0) && (col >= 0) && (width >= 0) && (row < m_board.Height()) && ((col+width) <= m_board.Width()))
 	{
 		output.resize(width);
-		for (int index = 0; index < width; index++)
-			output[index] = m_board[row][index+col];
+		m_board.ReadH(row, col, width, &output[0]);
 		success = true;
 	}
 	return success;
 }
 
+/// <summary>
+/// Gets a rectangle of the board as rows of text.  Only the squares inside the rectangle are read, so on
+/// a sparse board only the tiles it overlaps are visited.
+/// </summary>
+/// <param name="row">The top row.</param>
+/// <param name="col">The left col.</param>
+/// <param name="width">The number of columns.</param>
+/// <param name="height">The number of rows.</param>
+/// <param name="output">Set to one string per row.</param>
+/// <returns>true on success, false if the rectangle is not on the board</returns>
+template <class Storage>
+bool BasicWordBoard<Storage>::GetBoardRegion(int row, int col, int width, int height, std::vector<std::string> &output)
+{
+	bool success = false;
+	if (m_initialized && (height >= 0) && ((row + height) <= m_board.Height()))
+	{
+		success = true;
+		output.resize(height);
+		for (int nRow = 0; success && (nRow < height); nRow++)
+			success = GetBoardTextH(row + nRow, col, width, output[nRow]);
+	}
+	return success;
+}
+
 /// <summary>
 /// Sets the horizontal board contents at row,col for the length of the string to the given string.
 /// </summary>
@@ -363,13 +652,13 @@ bool WordBoard::GetBoardTextH(int row, int col, int width, std::string &output)
 /// <param name="col">The col (0..board width).</param>
 /// <param name="value">The value to set the board to.</param>
 /// <returns></returns>
-bool WordBoard::SetBoardTextH(int row, int col, std::string value)
+template <class Storage>
+bool BasicWordBoard<Storage>::SetBoardTextH(int row, int col, const std::string &value)
 {
-	bool success;
-	if ((row >= 0) && (col >= 0) && (row < m_heightBoard) && ((col + int(value.length())) <= m_widthBoard))
+	bool success = false;
+	if ((row >= 0) && (col >= 0) && (row < m_board.Height()) && ((col + int(value.length())) <= m_board.Width()))
 	{
-		for (int nCol = col; nCol < (col + int(value.length())); nCol++)
-			m_board[row][nCol] = value[nCol - col];
+		m_board.WriteH(row, col, value.data(), int(value.length()));
 		success = true;
 	}
 	return success;
@@ -383,14 +672,14 @@ bool WordBoard::SetBoardTextH(int row, int col, std::string value)
 /// <param name="height">The number of characters from the board to get (length but going from top down).</param>
 /// <param name="output">Set to the contents of the board from the position downward.</param>
 /// <returns></returns>
-bool WordBoard::GetBoardTextV(int row, int col, int height, std::string &output)
+template <class Storage>
+bool BasicWordBoard<Storage>::GetBoardTextV(int row, int col, int height, std::string &output)
 {
-	bool success;
-	if ((row >= 0) && (col >= 0) && (row < m_heightBoard) && ((row + height) <= m_heightBoard))
+	bool success = false;
+	if ((row >= 0) && (col >= 0) && (height >= 0) && (col < m_board.Width()) && ((row + height) <= m_board.Height()))
 	{
 		output.resize(height);
-		for (int nRow = row; nRow < (row + height); nRow++)
-			output[nRow - row] = m_board[nRow][col];
+		m_board.ReadV(row, col, height, &output[0]);
 		success = true;
 	}
 	return success;
@@ -403,13 +692,13 @@ bool WordBoard::GetBoardTextV(int row, int col, int height, std::string &output)
 /// <param name="col">The col (0..board width).</param>
 /// <param name="value">The contents to set the board to.</param>
 /// <returns></returns>
-bool WordBoard::SetBoardTextV(int row, int col, std::string value)
+template <class Storage>
+bool BasicWordBoard<Storage>::SetBoardTextV(int row, int col, const std::string &value)
 {
-	bool success;
-	if ((row >= 0) && (col >= 0) && (row < m_heightBoard) && ((row + int(value.length())) <= m_heightBoard))
+	bool success = false;
+	if ((row >= 0) && (col >= 0) && (col < m_board.Width()) && ((row + int(value.length())) <= m_board.Height()))
 	{
-		for (int nRow = row; nRow < (row + int(value.length())); nRow++)
-			m_board[nRow][col] = value[nRow - row];
+		m_board.WriteV(row, col, value.data(), int(value.length()));
 		success = true;
 	}
 	return success;
@@ -420,7 +709,8 @@ bool WordBoard::SetBoardTextV(int row, int col, std::string value)
 /// </summary>
 /// <param name="move">The move.</param>
 /// <returns></returns>
-bool WordBoard::ApplyMove(const WordBoardMove &move)
+template <class Storage>
+bool BasicWordBoard<Storage>::ApplyMove(const WordBoardMove &move)
 {
 	bool success = false;
 	if (dirHorizontal == move.m_direction)
@@ -439,7 +729,8 @@ bool WordBoard::ApplyMove(const WordBoardMove &move)
 /// </summary>
 /// <param name="move">The move.</param>
 /// <returns></returns>
-bool WordBoard::UndoMove(const WordBoardMove &move)
+template <class Storage>
+bool BasicWordBoard<Storage>::UndoMove(const WordBoardMove &move)
 {
 	bool success = false;
 	if (dirHorizontal == move.m_direction)
@@ -453,42 +744,289 @@ bool WordBoard::UndoMove(const WordBoardMove &move)
 	return success;
 }
 
-bool WordBoard::Undo(std::string &errorText) // Pull last move off m_undoMoves to undo and push onto m_redoMoves
+/// <summary>
+/// Empties the list of moves, keeping the records in m_freeMoves for reuse.
+/// </summary>
+/// <param name="moves">The list to empty.</param>
+template <class Storage>
+void BasicWordBoard<Storage>::ReleaseMoves(MoveContainer &moves)
 {
-	bool success = false;
-	if (!m_Moves.empty())
+	for (auto &move : moves)
+		m_freeMoves.push_back(std::move(move));
+	moves.clear();
+}
+
+template <class Storage>
+bool BasicWordBoard<Storage>::Undo(std::string &errorText) // Pull last move off m_undoMoves to undo and push onto m_redoMoves
+{
+	PlacementResult result = Undo();
+	if (!result.IsOk())
+		GetResultText(result, std::string(), errorText);
+	return result.IsOk();
+}
+
+template <class Storage>
+bool BasicWordBoard<Storage>::Redo(std::string &errorText) // Pull last move off m_redoMoves to redo and push onto m_undoMoves
+{
+	PlacementResult result = Redo();
+	if (!result.IsOk())
+		GetResultText(result, std::string(), errorText);
+	return result.IsOk();
+}
+
+template <class Storage>
+PlacementResult BasicWordBoard<Storage>::Undo()
+{
+	if (m_Moves.empty())
+		return MakePlacementResult(placeNothingToUndo, 0, 0, dirHorizontal, 0);
+	const WordBoardMove &move = m_Moves.back();
+	PlacementResult result = MakePlacementResult(placeOk, move.m_StartRow, move.m_StartCol, move.m_direction, int(move.m_newText.length()));
+	if (UndoMove(move))
+	{
+		m_redoMoves.push_back(std::move(m_Moves.back()));
+		m_Moves.pop_back();
+		if (m_changeFeed)
+			m_changeFeed->PublishMove(changeUndo, m_redoMoves.back());
+	}
+	else
+		result.m_code = placeUndoFailed;
+	return result;
+}
+
+template <class Storage>
+PlacementResult BasicWordBoard<Storage>::Redo()
+{
+	if (m_redoMoves.empty())
+		return MakePlacementResult(placeNothingToRedo, 0, 0, dirHorizontal, 0);
+	const WordBoardMove &move = m_redoMoves.back();
+	PlacementResult result = MakePlacementResult(placeOk, move.m_StartRow, move.m_StartCol, move.m_direction, int(move.m_newText.length()));
+	if (ApplyMove(move))
+	{
+		m_Moves.push_back(std::move(m_redoMoves.back()));
+		m_redoMoves.pop_back();
+		if (m_changeFeed)
+			m_changeFeed->PublishMove(changeRedo, m_Moves.back());
+	}
+	else
+		result.m_code = placeRedoFailed;
+	return result;
+}
+
+/*
+Saved board layout (all integers little endian, "var" is a 7 bits per byte variable length integer):
+
+	"WBRD"                  magic
+	uint16                  format version (BoardFormatVersion)
+	var width, var height
+	rows                    per row, pairs of (var empty run, var letter count, letters) until the row is full
+	var count, moves        undo list, oldest move first
+	var count, moves        redo list, in list order (last is the next move to redo)
+	uint64                  FNV-1a hash of everything above
+
+	move = var row, var col, byte direction, var length, original text, var length, new text
+
+Empty squares are run length encoded and letters are copied as is, so both Save and Load are a
+single pass of memcpy/memset sized operations over the data.
+*/
+namespace
+{
+	const char BoardMagic[4] = { 'W', 'B', 'R', 'D' };
+	const uint16_t BoardFormatVersion = 1;
+
+	void WriteText(BinaryWriter &writer, const std::string &text)
+	{
+		writer.VarUInt(text.length());
+		writer.Bytes(text.data(), text.length());
+	}
+
+	bool ReadText(BinaryReader &reader, std::string &text)
 	{
+		size_t length = size_t(reader.VarUInt());
+		const char *data = reader.Bytes(length);
+		if (NULL != data)
+			text.assign(data, length);
+		return reader.IsOk();
+	}
 
-		if (UndoMove(m_Moves.back()))
+	template <class Container>
+	void WriteMoves(BinaryWriter &writer, const Container &moves)
+	{
+		writer.VarUInt(moves.size());
+		for (const WordBoardMove &move : moves)
 		{
-			m_redoMoves.push_back(m_Moves.back());
-			m_Moves.pop_back();
-			success = true;
+			writer.VarUInt(uint64_t(move.m_StartRow));
+			writer.VarUInt(uint64_t(move.m_StartCol));
+			writer.Byte(uint8_t(move.m_direction));
+			WriteText(writer, move.m_originalText);
+			WriteText(writer, move.m_newText);
 		}
-		else
-			errorText = "Error undoing the move";
 	}
-	else
-		errorText = "Undo list is empty, nothing to undo";
-	return success;
+
+	template <class Container>
+	bool ReadMoves(BinaryReader &reader, int width, int height, Container &moves)
+	{
+		uint64_t count = reader.VarUInt();
+		for (uint64_t i = 0; reader.IsOk() && (i < count); i++)
+		{
+			WordBoardMove move;
+			uint64_t row = reader.VarUInt();
+			uint64_t col = reader.VarUInt();
+			uint8_t direction = reader.Byte();
+			if (!ReadText(reader, move.m_originalText) || !ReadText(reader, move.m_newText))
+				return false;
+			// make sure the move fits on the board so a later Undo/Redo cannot go out of bounds
+			uint64_t length = move.m_newText.length();
+			bool valid = (row < uint64_t(height)) && (col < uint64_t(width)) && (length == move.m_originalText.length());
+			if (valid && (dirHorizontal == direction))
+				valid = (col + length) <= uint64_t(width);
+			else if (valid && (dirVertical == direction))
+				valid = (row + length) <= uint64_t(height);
+			else
+				valid = false;
+			if (!valid)
+				return false;
+			move.m_StartRow = int(row);
+			move.m_StartCol = int(col);
+			move.m_direction = DirectionType(direction);
+			moves.push_back(move);
+		}
+		return reader.IsOk();
+	}
 }
 
-bool WordBoard::Redo(std::string &errorText) // Pull last move off m_redoMoves to redo and push onto m_undoMoves
+/// <summary>
+/// Saves the board contents and the undo/redo lists in the binary layout described above.
+/// </summary>
+/// <param name="output">Set to the saved data.</param>
+/// <returns>true on success, false if the board is not initialized or is too large to load again</returns>
+template <class Storage>
+bool BasicWordBoard<Storage>::Save(std::vector<char> &output)
 {
-	bool success = false;
-	if (!m_redoMoves.empty())
+	output.clear();
+	if (!m_initialized || ((uint64_t(m_board.Width()) * uint64_t(m_board.Height())) > MaxBoardCells))
+		return false;
+
+	BinaryWriter writer(output);
+	writer.Bytes(BoardMagic, sizeof(BoardMagic));
+	writer.UInt16(BoardFormatVersion);
+	writer.VarUInt(uint64_t(m_board.Width()));
+	writer.VarUInt(uint64_t(m_board.Height()));
+	std::string row;
+	for (int nRow = 0; nRow < m_board.Height(); nRow++)
 	{
+		GetBoardRow(nRow, row);
+		const char *cells = row.data();
+		int nCol = 0;
+		while (nCol < m_board.Width())
+		{
+			int empty = nCol;
+			while ((empty < m_board.Width()) && (' ' == cells[empty]))
+				empty++;
+			int letters = empty;
+			while ((letters < m_board.Width()) && (' ' != cells[letters]))
+				letters++;
+			writer.VarUInt(uint64_t(empty - nCol));
+			writer.VarUInt(uint64_t(letters - empty));
+			writer.Bytes(cells + empty, size_t(letters - empty));
+			nCol = letters;
+		}
+	}
+	WriteMoves(writer, m_Moves);
+	WriteMoves(writer, m_redoMoves);
+	writer.UInt64(HashBytes(output.data(), output.size()));
+	return true;
+}
+
+/// <summary>
+/// Restores a board saved with Save - the size, contents and undo/redo lists are replaced exactly.
+/// Nothing is changed if the data is not valid.
+/// </summary>
+/// <param name="data">The saved data.</param>
+/// <param name="size">The size of the saved data.</param>
+/// <param name="errorText">Set to the reason on failure.</param>
+/// <returns>true on success, false on failure</returns>
+template <class Storage>
+bool BasicWordBoard<Storage>::Load(const char *data, size_t size, std::string &errorText)
+{
+	if (!m_initialized)
+	{
+		errorText = "Board must be initialized (word list loaded) before loading";
+		return false;
+	}
+	if ((size < sizeof(BoardMagic) + 2 + 8) || (0 != memcmp(data, BoardMagic, sizeof(BoardMagic))))
+	{
+		errorText = "Data is not a saved board";
+		return false;
+	}
+	BinaryReader trailer(data + size - 8, 8);
+	if (trailer.UInt64() != HashBytes(data, size - 8))
+	{
+		errorText = "Saved board is corrupt (hash does not match)";
+		return false;
+	}
+
+	BinaryReader reader(data, size - 8);
+	reader.Bytes(sizeof(BoardMagic));
+	if (BoardFormatVersion != reader.UInt16())
+	{
+		errorText = "Saved board format version is not supported";
+		return false;
+	}
+	uint64_t width = reader.VarUInt();
+	uint64_t height = reader.VarUInt();
+	// each checked on its own first so the multiply can not overflow and the sizes fit in an int
+	if ((0 == width) || (0 == height) || (width > uint64_t(INT_MAX)) || (height > uint64_t(INT_MAX)) || (width > (MaxBoardCells / height)))
+	{
+		errorText = "Saved board has an invalid size";
+		return false;
+	}
 
-		if (ApplyMove(m_redoMoves.back()))
+	// Read into new containers so the board is untouched if anything is wrong
+	Storage board;
+	if (!reader.IsOk() || !board.Resize(int(width), int(height)))
+	{
+		errorText = "Saved board size does not match this board";
+		return false;
+	}
+	board.Fill(' ');
+	bool valid = true;
+	for (int nRow = 0; valid && (nRow < int(height)); nRow++)
+	{
+		uint64_t nCol = 0;
+		while (valid && (nCol < width))
 		{
-			m_Moves.push_back(m_redoMoves.back());
-			m_redoMoves.pop_back();
-			success = true;
+			uint64_t empty = reader.VarUInt();
+			uint64_t letters = reader.VarUInt();
+			const char *letterData = reader.Bytes(size_t(letters));
+			// each run checked on its own before adding, so hostile values can not wrap around
+			valid = reader.IsOk() && (empty <= (width - nCol)) && (letters <= (width - nCol - empty)) && ((empty + letters) > 0);
+			if (valid)
+			{
+				board.WriteH(nRow, int(nCol + empty), letterData, int(letters)); // empty squares are already ' '
+				nCol += empty + letters;
+			}
 		}
-		else
-			errorText = "Error undoing the move";
 	}
-	else
-		errorText = "Undo list is empty, nothing to undo";
-	return success;
-}
\ No newline at end of file
+	MoveContainer moves;
+	MoveContainer redoMoves;
+	valid = valid && ReadMoves(reader, int(width), int(height), moves) && ReadMoves(reader, int(width), int(height), redoMoves) && (0 == reader.Remaining());
+	if (!valid)
+	{
+		errorText = "Saved board data is not valid";
+		return false;
+	}
+
+	m_board = std::move(board);
+	UpdateScorer();
+	m_Moves.swap(moves);
+	m_redoMoves.swap(redoMoves);
+	if (m_changeFeed)
+		m_changeFeed->PublishReset();
+	return true;
+}
+
+// Explicit instantiations - the dynamic board and the fixed board sizes in common use
+template class BasicWordBoard<DynamicBoardStorage>;
+template class BasicWordBoard<FixedBoardStorage<15, 15>>;
+template class BasicWordBoard<FixedBoardStorage<19, 19>>;
+template class BasicWordBoard<SparseBoardStorage>;
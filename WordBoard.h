@@ -14,8 +14,16 @@ capabilities.  Though not in the original problem statement, it was added for "e
 
 #include "string"
 #include "WordValidator.h"
+#include "BoardStorage.h"
+#include "WordScorer.h"
+#include <cstdint>
 #include <vector>
-#include <list>
+#include <memory>
+
+class WordBoardChangeFeed;
+
+// The most squares a board may have - sanity limit for sizes from outside the program (Load, commands, logs)
+const uint64_t MaxBoardCells = uint64_t(1) << 28;
 
 // Direction of word - horizontal (left->right) or vertical (top->down)
 typedef enum {
@@ -36,58 +44,173 @@ public:
 	std::string m_newText;
 };
 
+// Outcome of placing a word (or of undo/redo) - see PlacementResult
+typedef enum {
+	placeOk, /// Done
+	placeNotInitialized, /// Init has not been called (or failed)
+	placeOutsideBoard, /// The start square is not on the board
+	placeBeyondEdge, /// The word would go beyond the right/bottom edge of the board
+	placeLetterConflict, /// A letter of the word differs from the letter already on its square
+	placeInvalidWord, /// The first word is not in the word list
+	placeInvalidCrossWord, /// A word formed across the placement is not in the word list
+	placeInvalidMainWord, /// The word, with any letters either side of it, is not in the word list
+	placeNotAttached, /// A word after the first does not touch any letter on the board
+	placeNothingToUndo, /// The undo list is empty
+	placeNothingToRedo, /// The redo list is empty
+	placeUndoFailed, /// The move being undone no longer fits the board
+	placeRedoFailed /// The move being redone no longer fits the board
+} PlacementCode;
+
+/// <summary>
+/// The result of AddWordH/AddWordV/Undo/Redo - a reason code and where the problem is, with no strings built.
+/// Use GetResultText on the board for a message (only needed when someone is going to read it).
+/// </summary>
+class PlacementResult
+{
+public:
+	bool IsOk() const { return placeOk == m_code; }
+
+	PlacementCode m_code;
+	int m_score; // score of the move when placed
+	// The word at fault - for invalid words the span of letters checked, otherwise the placement itself
+	int m_row;
+	int m_col;
+	DirectionType m_direction;
+	int m_length;
+	// Where the word was being placed (the message puts its letters back on the board to show the word at fault)
+	int m_moveRow;
+	int m_moveCol;
+	DirectionType m_moveDirection;
+};
+
+/// <summary>
+/// A move to score with ScoreMoves - where the word goes and the letters
+/// </summary>
+class WordBoardCandidate
+{
+public:
+	int m_row;
+	int m_col;
+	DirectionType m_direction;
+	std::string m_word;
+};
+
 /// <summary>
-/// This holds the board contents, methods to manipulate the board and contents and the sequence of moves applied to that board
+/// This holds the board contents, methods to manipulate the board and contents and the sequence of moves applied to that board.
+/// The squares are held by Storage (see BoardStorage.h) - use WordBoard for a size chosen at runtime or FixedWordBoard<W, H>
+/// for a size fixed at compile time (no heap for the squares, constant bounds and strides).
 /// </summary>
-class WordBoard
+template <class Storage>
+class BasicWordBoard
 {
 public:
-	WordBoard();
-	~WordBoard();
+	BasicWordBoard();
+	~BasicWordBoard();
 
 	// Initializes the board width/height and clears to empty (spaces ' ')
 	bool Init(int width, int height);
+	bool Init(int width, int height, std::shared_ptr<const WordValidator> validator); // share an already loaded word list
+	bool Clear(); // clears the board contents and undo/redo lists, keeping the size and word list (for reusing boards)
+	std::shared_ptr<const WordValidator> GetValidator() { return m_wordValidator; }
 
 	// Get the board information / contents
-	int GetNumColumns() { return m_widthBoard; }
-	int GetNumRows() { return m_heightBoard; }
+	int GetNumColumns() { return m_board.Width(); }
+	int GetNumRows() { return m_board.Height(); }
+	const Storage &GetStorage() const { return m_board; }
 	bool GetBoard(std::vector<std::string> &output); // return a vector of strings holding the board contents
 
 	// Add words to board - returns true on success, false on cannot do it and sets errorText
 	bool AddWordH(int row, int col, const std::string &word, std::string & errorText);
 	bool AddWordV(int row, int col, const std::string &word, std::string & errorText);
+	bool AddWordH(int row, int col, const std::string &word, std::string & errorText, int &score); // also sets the score of the move
+	bool AddWordV(int row, int col, const std::string &word, std::string & errorText, int &score);
+
+	// Add words to board without building error text - for trying many candidates.  GetResultText makes the message
+	// for a failure, as long as the board has not been changed since (word is the word that was being placed).
+	PlacementResult AddWordH(int row, int col, const std::string &word);
+	PlacementResult AddWordV(int row, int col, const std::string &word);
+	PlacementResult Undo();
+	PlacementResult Redo();
+	void GetResultText(const PlacementResult &result, const std::string &word, std::string &text) const;
+
+	// Scoring - letter values and premium squares (a default layout for the board size is set up by Init)
+	bool SetScorer(std::shared_ptr<const WordScorer> scorer);
+	std::shared_ptr<const WordScorer> GetScorer() { return m_scorer; }
+	bool ScoreMoves(const std::vector<WordBoardCandidate> &candidates, std::vector<int> &scores) const; // scores without changing the board
+
+	// Change feed - publishes the squares changed by each add/undo/redo (see WordBoardChangeFeed.h)
+	void SetChangeFeed(std::shared_ptr<WordBoardChangeFeed> changeFeed);
+	std::shared_ptr<WordBoardChangeFeed> GetChangeFeed() { return m_changeFeed; }
 
 	// Undo/Redo functions
 	bool HasUndo() { return !m_Moves.empty(); }
 	bool HasRedo() { return !m_redoMoves.empty(); } // Normally, redo is empty unless you have done Undo and NOT added any moves
 	bool Undo(std::string &errorText); // Pull last move off m_undoMoves to undo and push onto m_redoMoves
 	bool Redo(std::string &errorText); // Pull last move off m_redoMoves to redo and push onto m_undoMoves
+	// The move Undo/Redo would undo/redo - the pointer is only valid until the board is next changed
+	const WordBoardMove *GetLastMove() const { return m_Moves.empty() ? NULL : &m_Moves.back(); }
+	const WordBoardMove *GetLastRedoMove() const { return m_redoMoves.empty() ? NULL : &m_redoMoves.back(); }
 
 	// Get specific squares from the board - returns true on success, false on failure
 	bool GetBoardTextH(int row, int col, int width, std::string &output);
 	bool GetBoardTextV(int row, int col, int height, std::string &output);
+	bool GetBoardRegion(int row, int col, int width, int height, std::vector<std::string> &output); // rows of a rectangle, only reads those squares
+
+	// Save / restore the board contents and undo/redo lists in a compact, versioned binary form.
+	// Load needs an initialized board (word list loaded) and replaces its size, contents and undo/redo lists.
+	bool Save(std::vector<char> &output);
+	bool Load(const char *data, size_t size, std::string &errorText);
 
 private:
-	bool SetBoardTextH(int row, int col, std::string value);
-	bool SetBoardTextV(int row, int col, std::string value);
+	// Stores 'Moves' for undo/redo function.  Records are never freed while the board is in use - they move
+	// between the undo/redo lists and m_freeMoves, keeping their string buffers, so once the board has warmed
+	// up adding words and undo/redo do not touch the heap.
+	typedef std::vector<WordBoardMove> MoveContainer;
+
+	bool SetBoardTextH(int row, int col, const std::string &value);
+	bool SetBoardTextV(int row, int col, const std::string &value);
+	PlacementResult AddWord(int row, int col, DirectionType direction, const std::string &word);
+	int ScorePlacement(int row, int col, DirectionType direction, const char *letters, const char *original, int length) const;
+	void UpdateScorer();
 	bool ApplyMove(const WordBoardMove &move);
 	bool UndoMove(const WordBoardMove &move);
+	void ReleaseMoves(MoveContainer &moves);
 	bool GetBoardAt(int row, int col, char &value); // return the character at the specied position
 	bool GetBoardRow(int row, std::string &output); // return the specific row as a string
 	bool GetBoardCol(int col, std::string &output); // return the specific col as a string
 	bool GetWordH(int row, int col, std::string &word); // return the word left<->right from this point with spaces breaking words or boundaries
 	bool GetWordV(int row, int col, std::string &word); // return the word top<->bottom from this point with spaces breaking words or boundaries
-
-	typedef std::vector<char> ColumnContainer;
-	typedef std::vector<ColumnContainer> RowContainer;
-	typedef std::list<WordBoardMove> MoveContainer; // stores 'Moves' for undo/redo function
+	int GetWordSpan(int &row, int &col, DirectionType direction) const; // moves row/col to the start of the word through it and returns its length
+	bool CheckWord(int row, int col, DirectionType direction, int length, PlacementCode failure, PlacementResult &result); // validates a word on the board
 
 	bool m_initialized;
-	int m_widthBoard;
-	int m_heightBoard;
-	RowContainer m_board;
+	Storage m_board;
 	MoveContainer m_Moves;
 	MoveContainer m_redoMoves;
-	WordValidator m_wordValidator;
+	MoveContainer m_freeMoves; // pool of spare move records
+	std::string m_wordText; // scratch for the words AddWord checks
+	std::shared_ptr<const WordValidator> m_wordValidator; // shared between boards so the word list is only loaded once
+	std::shared_ptr<const WordScorer> m_scorer; // letter values and premium squares, shared like the word list
+	std::shared_ptr<WordBoardChangeFeed> m_changeFeed; // NULL unless someone is following the changes
 };
 
+
+// Board sized at runtime by Init
+typedef BasicWordBoard<DynamicBoardStorage> WordBoard;
+
+// Board sized at compile time - Init must be called with the same width/height.  The member functions are
+// compiled in WordBoard.cpp, so sizes other than the ones instantiated there need adding to the list at its end.
+template <int W, int H>
+using FixedWordBoard = BasicWordBoard<FixedBoardStorage<W, H>>;
+
+typedef FixedWordBoard<15, 15> WordBoard15x15;
+typedef FixedWordBoard<19, 19> WordBoard19x19;
+
+// Very large, mostly empty board - memory is proportional to the 64x64 tiles holding letters.  GetBoard and
+// Save still visit every square, use GetBoardRegion/GetBoardTextH/GetBoardTextV to read parts of it.
+typedef BasicWordBoard<SparseBoardStorage> SparseWordBoard;
+
+extern template class BasicWordBoard<DynamicBoardStorage>;
+extern template class BasicWordBoard<FixedBoardStorage<15, 15>>;
+extern template class BasicWordBoard<FixedBoardStorage<19, 19>>;
+extern template class BasicWordBoard<SparseBoardStorage>;
@@ -0,0 +1,124 @@
+/*
+Change feed for a WordBoard - see WordBoardChangeFeed.h
+*/
+
+#include "stdafx.h"
+#include "WordBoardChangeFeed.h"
+#include <algorithm>
+
+WordBoardChangeFeed::WordBoardChangeFeed(size_t historySize)
+	: m_historySize(historySize)
+	, m_sequence(0)
+	, m_nextListenerId(1)
+{
+}
+
+WordBoardChangeFeed::~WordBoardChangeFeed()
+{
+}
+
+int WordBoardChangeFeed::Subscribe(Listener listener)
+{
+	std::lock_guard<std::mutex> guard(m_lock);
+	int id = m_nextListenerId++;
+	m_listeners[id] = listener;
+	return id;
+}
+
+bool WordBoardChangeFeed::Unsubscribe(int id)
+{
+	std::lock_guard<std::mutex> guard(m_lock);
+	return m_listeners.erase(id) > 0;
+}
+
+uint64_t WordBoardChangeFeed::GetSequence() const
+{
+	std::lock_guard<std::mutex> guard(m_lock);
+	return m_sequence;
+}
+
+/// <summary>
+/// Gets the changes made after the given sequence number, oldest first.
+/// </summary>
+/// <param name="sequence">The last sequence number the caller has seen.</param>
+/// <param name="changes">Set to the changes after it (empty if the caller is up to date).</param>
+/// <returns>true on success, false if the changes are no longer kept or the board was reset since (resync with GetBoard and GetSequence)</returns>
+bool WordBoardChangeFeed::GetChangesSince(uint64_t sequence, std::vector<WordBoardChange> &changes) const
+{
+	std::lock_guard<std::mutex> guard(m_lock);
+	changes.clear();
+	if (sequence > m_sequence)
+		return false; // from some other board (or feed)
+	if (sequence == m_sequence)
+		return true;
+	if (m_history.empty() || (m_history.front().m_sequence > (sequence + 1)))
+		return false;
+	auto first = m_history.begin() + size_t(sequence + 1 - m_history.front().m_sequence);
+	if (std::any_of(first, m_history.end(), [](const WordBoardChange &change) { return changeReset == change.m_type; }))
+		return false; // a reset carries no squares, so deltas can not bring the caller's copy up to date
+	changes.assign(first, m_history.end());
+	return true;
+}
+
+/// <summary>
+/// Publishes a move that was added, undone or redone - the squares listed are the ones whose
+/// contents changed (letters already on the board under the word are left out).
+/// </summary>
+/// <param name="type">The kind of change.</param>
+/// <param name="move">The move.</param>
+void WordBoardChangeFeed::PublishMove(ChangeType type, const WordBoardMove &move)
+{
+	const std::string &before = (changeUndo == type) ? move.m_newText : move.m_originalText;
+	const std::string &after = (changeUndo == type) ? move.m_originalText : move.m_newText;
+	bool horizontal = (dirHorizontal == move.m_direction);
+
+	WordBoardChange change;
+	change.m_type = type;
+	change.m_cells.reserve(after.length());
+	for (size_t index = 0; index < after.length(); index++)
+	{
+		if (before[index] != after[index])
+		{
+			WordBoardCellDelta cell;
+			cell.m_row = move.m_StartRow + (horizontal ? 0 : int(index));
+			cell.m_col = move.m_StartCol + (horizontal ? int(index) : 0);
+			cell.m_value = after[index];
+			change.m_cells.push_back(cell);
+		}
+	}
+	Publish(change);
+}
+
+void WordBoardChangeFeed::PublishReset()
+{
+	WordBoardChange change;
+	change.m_type = changeReset;
+	Publish(change);
+}
+
+/// <summary>
+/// Numbers the change, keeps it and calls the listeners.  The listeners are called without m_lock held
+/// (from a copy of the list) so they can use the feed - m_publishLock keeps them in sequence order.
+/// </summary>
+void WordBoardChangeFeed::Publish(WordBoardChange &change)
+{
+	std::lock_guard<std::mutex> publishing(m_publishLock);
+	const WordBoardChange *published = &change;
+	{
+		std::lock_guard<std::mutex> guard(m_lock);
+		change.m_sequence = ++m_sequence;
+		if (m_historySize > 0)
+		{
+			if (m_history.size() >= m_historySize)
+				m_history.pop_front();
+			m_history.push_back(std::move(change));
+			published = &m_history.back(); // only changed by Publish, so stays valid while m_publishLock is held
+		}
+		m_calling.clear();
+		for (auto &listener : m_listeners)
+			m_calling.push_back(listener.second);
+	}
+	for (auto &listener : m_calling)
+		listener(*published);
+	m_calling.clear(); // do not keep unsubscribed listeners (and what they hold) alive
+}
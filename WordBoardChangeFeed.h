@@ -0,0 +1,83 @@
+/*
+Change feed for a WordBoard - instead of polling GetBoard after every move, front ends subscribe and
+receive each change as the squares that changed.
+
+Every change has a sequence number (1, 2, 3...).  A client that falls behind or reconnects asks for
+the changes since the last sequence number it saw; if those are no longer kept (or the board was
+reset) it takes a full copy with GetBoard together with GetSequence and continues from there.
+*/
+
+#pragma once
+
+#include "WordBoard.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// What caused a change
+typedef enum {
+	changeAdd, /// A word was added
+	changeUndo, /// A move was undone
+	changeRedo, /// A move was redone
+	changeReset /// The board was cleared, resized or loaded - take a full copy of the board
+} ChangeType;
+
+/// <summary>
+/// One square that changed and its new contents
+/// </summary>
+class WordBoardCellDelta
+{
+public:
+	int m_row;
+	int m_col;
+	char m_value;
+};
+
+/// <summary>
+/// One change to the board - only the squares whose contents actually changed are listed
+/// </summary>
+class WordBoardChange
+{
+public:
+	uint64_t m_sequence;
+	ChangeType m_type;
+	std::vector<WordBoardCellDelta> m_cells;
+};
+
+class WordBoardChangeFeed
+{
+public:
+	typedef std::function<void(const WordBoardChange &)> Listener;
+
+	WordBoardChangeFeed(size_t historySize = 1024); // number of changes kept for GetChangesSince
+	~WordBoardChangeFeed();
+
+	// Listeners are called on the thread changing the board, in sequence order, and may call any method
+	// here except PublishMove/PublishReset (or change a board using this feed).  A listener added or
+	// removed while a change is being published is called or not from the next change.
+	int Subscribe(Listener listener); // returns an id for Unsubscribe
+	bool Unsubscribe(int id);
+
+	uint64_t GetSequence() const; // sequence number of the latest change (0 if none)
+	// Gets the changes after 'sequence' - false if they are no longer kept or the board was reset, then resync with GetBoard
+	bool GetChangesSince(uint64_t sequence, std::vector<WordBoardChange> &changes) const;
+
+	// Called by the board
+	void PublishMove(ChangeType type, const WordBoardMove &move);
+	void PublishReset();
+
+private:
+	void Publish(WordBoardChange &change);
+
+	mutable std::mutex m_lock; // guards everything below except m_calling
+	std::mutex m_publishLock; // one Publish at a time, so listeners see changes in order
+	std::vector<Listener> m_calling; // copy of the listeners being called (guarded by m_publishLock)
+	size_t m_historySize;
+	uint64_t m_sequence;
+	std::deque<WordBoardChange> m_history;
+	std::map<int, Listener> m_listeners;
+	int m_nextListenerId;
+};
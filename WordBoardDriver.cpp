@@ -0,0 +1,34 @@
+// WordBoardDriver.cpp : Runs WordBoard commands from stdin and writes the responses to stdout (see CommandDriver.h).
+//   WordBoardDriver [threads] [batchSize]
+// The throughput is written to stderr when the input ends.
+
+#include "stdafx.h"
+#include "WordBoard.h"
+#include "CommandDriver.h"
+#include <cstdlib>
+#include <iostream>
+
+using namespace std;
+
+int main(int argc, char *argv[])
+{
+	WordBoard board;
+	if (!board.Init(1, 1))
+	{
+		cerr << "Failure loading word list -- cannot run commands" << endl;
+		return 2;
+	}
+	CommandDriver driver;
+	driver.Initialize(board.GetValidator());
+	if (argc > 1)
+		driver.SetThreadCount(atoi(argv[1]));
+	if (argc > 2)
+		driver.SetBatchSize(atoi(argv[2]));
+
+	bool success = driver.Run(0, stdout);
+	if (!driver.GetReadError().empty())
+		cerr << driver.GetReadError() << endl;
+	cerr << "Executed " << driver.GetCommandCount() << " commands for " << driver.GetGameCount() << " games in " << driver.GetBatchCount() << " batches, "
+		<< driver.GetElapsedSeconds() << " seconds (" << driver.GetCommandsPerSecond() << " commands/sec)" << endl;
+	return success ? 0 : 1;
+}
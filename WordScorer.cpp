@@ -0,0 +1,172 @@
+/*
+Letter values and premium square layouts for scoring moves (see WordScorer.h)
+*/
+
+#include "stdafx.h"
+#include "WordScorer.h"
+#include <algorithm>
+#include <cctype>
+#include <cstring>
+#include <map>
+#include <mutex>
+
+namespace
+{
+	// Standard letter values A..Z
+	const int StandardLetterValues[26] = { 1, 3, 3, 2, 1, 4, 2, 4, 1, 8, 5, 1, 3, 1, 1, 3, 10, 1, 1, 1, 1, 4, 4, 8, 4, 10 };
+
+	// Top left quarter (including the centre row/column) of the standard 15x15 layout, the rest is mirrored.
+	// T = triple word, D = double word, t = triple letter, d = double letter
+	const char StandardQuarter[8][9] = {
+		"T..d...T",
+		".D...t..",
+		"..D...d.",
+		"d..D...d",
+		"....D...",
+		".t...t..",
+		"..d...d.",
+		"T..d...D",
+	};
+
+	PremiumType PremiumFromChar(char value)
+	{
+		switch (value)
+		{
+		case 'T': return premiumTripleWord;
+		case 'D': return premiumDoubleWord;
+		case 't': return premiumTripleLetter;
+		case 'd': return premiumDoubleLetter;
+		default: return premiumNone;
+		}
+	}
+
+	/// <summary>
+	/// Maps a position on a board of the given size into the 0..7 range of the standard quarter, folding
+	/// the far half onto the near half so the layout stays symmetric.  When the board is larger than 15
+	/// several positions map to the same quarter position, only the nearest one gets it (-1 for the others)
+	/// so premiums are spread out rather than doubled up.
+	/// </summary>
+	int FoldToQuarter(int pos, int size)
+	{
+		int fromEdge = std::min(pos, size - 1 - pos);
+		int half = (size - 1) / 2; // distance from the edge to the centre
+		if (half <= 0)
+			return 7;
+		int quarter = std::min(7, (fromEdge * 7 + half / 2) / half);
+		return (fromEdge == std::min(half, (quarter * half + 3) / 7)) ? quarter : -1;
+	}
+}
+
+WordScorer::WordScorer()
+	: m_width(0)
+	, m_height(0)
+	, m_bingoTiles(7)
+	, m_bingoBonus(50)
+{
+	memset(m_letterValues, 0, sizeof(m_letterValues));
+	for (int letter = 0; letter < 26; letter++)
+		SetLetterValue(char('A' + letter), StandardLetterValues[letter]);
+}
+
+WordScorer::~WordScorer()
+{
+}
+
+/// <summary>
+/// Gets the standard scorer for a board size from a cache of the scorers in use, making it if needed.
+/// </summary>
+/// <param name="width">The width of the board.</param>
+/// <param name="height">The height of the board.</param>
+/// <returns>The scorer, null if the size is not valid</returns>
+std::shared_ptr<const WordScorer> WordScorer::GetStandard(int width, int height)
+{
+	static std::mutex lock;
+	static std::map<std::pair<int, int>, std::weak_ptr<const WordScorer>> scorers; // weak, so sizes no longer used are freed
+	std::lock_guard<std::mutex> guard(lock);
+	std::weak_ptr<const WordScorer> &cached = scorers[std::make_pair(width, height)];
+	std::shared_ptr<const WordScorer> scorer = cached.lock();
+	if (!scorer)
+	{
+		std::shared_ptr<WordScorer> made = std::make_shared<WordScorer>();
+		if (!made->Init(width, height))
+			return nullptr;
+		scorer = made;
+		cached = scorer;
+	}
+	return scorer;
+}
+
+/// <summary>
+/// Sets up the premium square layout for the board size.
+/// </summary>
+/// <param name="width">The width of the board.</param>
+/// <param name="height">The height of the board.</param>
+/// <returns>true on success</returns>
+bool WordScorer::Init(int width, int height)
+{
+	if ((width < 1) || (height < 1))
+		return false;
+	m_width = width;
+	m_height = height;
+	m_premiums.clear();
+	m_letterMultipliers.clear();
+	m_wordMultipliers.clear();
+	m_changedPremiums.clear();
+	size_t squares = size_t(width) * size_t(height);
+	if (squares <= MaxTableSquares)
+	{
+		m_premiums.resize(squares);
+		m_letterMultipliers.resize(squares);
+		m_wordMultipliers.resize(squares);
+		for (int nRow = 0; nRow < height; nRow++)
+		{
+			for (int nCol = 0; nCol < width; nCol++)
+				SetPremium(nRow, nCol, LayoutPremium(nRow, nCol));
+		}
+	}
+	return true;
+}
+
+/// <summary>
+/// The premium for a square from the standard layout scaled to the board size.
+/// </summary>
+PremiumType WordScorer::LayoutPremium(int row, int col) const
+{
+	int quarterRow = FoldToQuarter(row, m_height);
+	int quarterCol = FoldToQuarter(col, m_width);
+	if ((quarterRow < 0) || (quarterCol < 0))
+		return premiumNone;
+	return PremiumFromChar(StandardQuarter[quarterRow][quarterCol]);
+}
+
+void WordScorer::SetLetterValue(char letter, int value)
+{
+	m_letterValues[(unsigned char)toupper((unsigned char)letter)] = value;
+	m_letterValues[(unsigned char)tolower((unsigned char)letter)] = value;
+}
+
+PremiumType WordScorer::GetPremium(int row, int col) const
+{
+	if ((row < 0) || (row >= m_height) || (col < 0) || (col >= m_width))
+		return premiumNone;
+	size_t index = size_t(row) * m_width + col;
+	if (!m_premiums.empty())
+		return PremiumType(m_premiums[index]);
+	auto changed = m_changedPremiums.find(index);
+	return (m_changedPremiums.end() != changed) ? PremiumType(changed->second) : LayoutPremium(row, col);
+}
+
+void WordScorer::SetPremium(int row, int col, PremiumType premium)
+{
+	if ((row < 0) || (row >= m_height) || (col < 0) || (col >= m_width))
+		return;
+	size_t index = size_t(row) * m_width + col;
+	if (m_premiums.empty())
+	{
+		m_changedPremiums[index] = (unsigned char)premium;
+		return;
+	}
+	m_premiums[index] = (unsigned char)premium;
+	m_letterMultipliers[index] = (unsigned char)LetterMultiplier(premium);
+	m_wordMultipliers[index] = (unsigned char)WordMultiplier(premium);
+}
@@ -0,0 +1,76 @@
+/*
+Scoring for words placed on a WordBoard - letter values and the premium square layout for a board size.
+
+A placed word scores the sum of its letter values times any word multipliers; premium squares only
+count for letters newly placed by the move.  A move scores its main word plus every cross word formed
+by a newly placed letter, plus a bonus when all the tiles of a rack (7) are placed at once.
+*/
+
+#pragma once
+
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+// Premium squares on the board
+typedef enum {
+	premiumNone, /// Plain square
+	premiumDoubleLetter, /// Letter placed here scores double
+	premiumTripleLetter, /// Letter placed here scores triple
+	premiumDoubleWord, /// Word through a letter placed here scores double
+	premiumTripleWord /// Word through a letter placed here scores triple
+} PremiumType;
+
+class WordScorer
+{
+public:
+	WordScorer();
+	~WordScorer();
+
+	// Sets standard letter values and the premium layout for the board size.  15x15 uses the standard
+	// layout, other sizes use the standard layout scaled to fit (same symmetry, centre is a double word).
+	// Boards over MaxTableSquares work the layout out per square instead of holding tables for it.
+	bool Init(int width, int height);
+	static const size_t MaxTableSquares = 1024 * 1024;
+
+	// The standard scorer for a board size, shared by every board of that size that is using it (made the
+	// first time it is asked for and kept while any board holds it).  Null if the size is not valid.
+	static std::shared_ptr<const WordScorer> GetStandard(int width, int height);
+
+	int GetWidth() const { return m_width; }
+	int GetHeight() const { return m_height; }
+
+	int GetLetterValue(char letter) const { return m_letterValues[(unsigned char)letter]; } // either case, 0 for blanks/non letters
+	void SetLetterValue(char letter, int value); // sets both upper and lower case
+	PremiumType GetPremium(int row, int col) const;
+	void SetPremium(int row, int col, PremiumType premium);
+
+	// Multipliers for a newly placed letter at a square (no range check)
+	int GetLetterMultiplier(int row, int col) const
+	{
+		return !m_letterMultipliers.empty() ? m_letterMultipliers[size_t(row) * m_width + col] : LetterMultiplier(GetPremium(row, col));
+	}
+	int GetWordMultiplier(int row, int col) const
+	{
+		return !m_wordMultipliers.empty() ? m_wordMultipliers[size_t(row) * m_width + col] : WordMultiplier(GetPremium(row, col));
+	}
+
+	int GetBingoTiles() const { return m_bingoTiles; }
+	int GetBingoBonus() const { return m_bingoBonus; }
+	void SetBingo(int tiles, int bonus) { m_bingoTiles = tiles; m_bingoBonus = bonus; }
+
+private:
+	static int LetterMultiplier(PremiumType premium) { return (premiumDoubleLetter == premium) ? 2 : (premiumTripleLetter == premium) ? 3 : 1; }
+	static int WordMultiplier(PremiumType premium) { return (premiumDoubleWord == premium) ? 2 : (premiumTripleWord == premium) ? 3 : 1; }
+	PremiumType LayoutPremium(int row, int col) const;
+
+	int m_width;
+	int m_height;
+	int m_letterValues[256];
+	std::vector<unsigned char> m_premiums;
+	std::vector<unsigned char> m_letterMultipliers; // precomputed from m_premiums so scoring is table lookups only
+	std::vector<unsigned char> m_wordMultipliers;
+	std::unordered_map<size_t, unsigned char> m_changedPremiums; // SetPremium changes for boards too big for the tables
+	int m_bingoTiles;
+	int m_bingoBonus;
+};
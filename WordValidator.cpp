@@ -7,12 +7,26 @@ Copyright 2018 - all rights held by the author.No reuse or publication without p
 #include "WordValidator.h"
 #include "resource.h"
 #include <cstdio>
+#include "ParallelFor.h"
 #include <algorithm>
 #include <fstream>
 #include <streambuf>
+#if defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2)) || defined(__SSE2__)
+#define WORDVALIDATOR_SSE2
+#include <emmintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#endif
+
+const uint32_t WordValidator::NoWord;
 
 WordValidator::WordValidator()
+	: m_largePages(false)
+	, m_nodeReplicas(false)
+	, m_wordCount(0)
 {
+	UseVectors();
 }
 
 
@@ -20,78 +34,373 @@ WordValidator::~WordValidator()
 {
 }
 
+/// <summary>
+/// compares two const char * data for the binary_search
+/// </summary>
+/// <param name="aux1">1st string</param>
+/// <param name="aux2">2nd string</param>
+/// <returns><c>true</c> if the 1st string is "less" than the 2nd, otherwise, <c>false</c>.</returns>
+bool compareFunction(const char *aux1, const char *aux2)
+{
+	if (strcmp(aux1, aux2) < 0)
+	{
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+
+namespace
+{
+	const size_t ParallelParseSize = 1024 * 1024; // lists smaller than this are parsed on one thread
+
+	inline bool IsSeparator(char value) { return ('\r' == value) || ('\n' == value); }
+
+	/// <summary>
+	/// Finds the next '\r' or '\n' at or after p (or end).  Uses SSE2 to test 16 bytes at a time where available.
+	/// </summary>
+	const char *FindSeparator(const char *p, const char *end)
+	{
+#if defined(WORDVALIDATOR_SSE2)
+		const __m128i cr = _mm_set1_epi8('\r');
+		const __m128i lf = _mm_set1_epi8('\n');
+		for (; (end - p) >= 16; p += 16)
+		{
+			__m128i block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+			int mask = _mm_movemask_epi8(_mm_or_si128(_mm_cmpeq_epi8(block, cr), _mm_cmpeq_epi8(block, lf)));
+			if (0 != mask)
+			{
+#if defined(_MSC_VER)
+				unsigned long index;
+				_BitScanForward(&index, static_cast<unsigned long>(mask));
+				return p + index;
+#else
+				return p + __builtin_ctz(unsigned(mask));
+#endif
+			}
+		}
+#endif
+		while ((p < end) && !IsSeparator(*p))
+			p++;
+		return p;
+	}
+
+	/// <summary>
+	/// Counts the words (runs of characters between separators) in [p, end)
+	/// </summary>
+	size_t CountWords(const char *p, const char *end)
+	{
+		size_t count = 0;
+		for (;;)
+		{
+			while ((p < end) && IsSeparator(*p))
+				p++;
+			if (p == end)
+				break;
+			count++;
+			p = FindSeparator(p, end);
+		}
+		return count;
+	}
+
+	/// <summary>
+	/// Null terminates the words in [p, end), storing pointers to them in output.  Returns true if the
+	/// words are in sorted order (so the caller only has to sort when needed).
+	/// </summary>
+	bool SplitWords(char *p, char *end, LPCSTR *output)
+	{
+		bool sorted = true;
+		LPCSTR previous = NULL;
+		size_t previousLength = 0;
+		for (;;)
+		{
+			while ((p < end) && IsSeparator(*p))
+				*p++ = '\0';
+			if (p == end)
+				break;
+			*output++ = p;
+			char *word = p;
+			p = const_cast<char*>(FindSeparator(p, end));
+			size_t length = size_t(p - word);
+			if ((NULL != previous) && sorted)
+			{
+				// same order as strcmp, but using the lengths as the last word's terminator belongs to the next chunk
+				int compare = memcmp(word, previous, std::min(length, previousLength));
+				sorted = (compare > 0) || ((0 == compare) && (length >= previousLength));
+			}
+			previous = word;
+			previousLength = length;
+		}
+		return sorted;
+	}
+
+	/// <summary>
+	/// Hash of a word for the hash index (FNV-1a)
+	/// </summary>
+	inline uint32_t HashWord(const char *word, size_t length)
+	{
+		uint32_t hash = 2166136261u;
+		for (size_t index = 0; index < length; index++)
+			hash = (hash ^ uint8_t(word[index])) * 16777619u;
+		return hash;
+	}
+
+	inline uint32_t LetterBit(char letter)
+	{
+		return ((letter >= 'A') && (letter <= 'Z')) ? (1u << (letter - 'A')) : 0;
+	}
+
+	/// <summary>
+	/// Upper case copy of a word - on the stack (in buffer) so checking a word does not allocate, longer words use upperWord
+	/// </summary>
+	const char *UpperCase(const std::string &word, char (&buffer)[64], std::string &upperWord)
+	{
+		char *upper = buffer;
+		if (word.length() >= sizeof(buffer))
+		{
+			upperWord.resize(word.length());
+			upper = &upperWord[0];
+		}
+		std::transform(word.begin(), word.end(), upper, [](char letter) { return char(::toupper((unsigned char)letter)); });
+		upper[word.length()] = '\0';
+		return upper;
+	}
+}
+
 /// <summary>
 /// Processes the word list, which is loaded into m_StringsBuffer, so we can create another vector
 /// with pointers to the strings within the buffer.  This lets us load very fast and just manipulate
 /// the data in memory without a lot of allocations.
+///
+/// Large lists are split into chunks (on line boundaries) that are parsed on separate threads: each
+/// chunk first counts its words, a running total of the counts gives each chunk its place in
+/// m_Strings, then each chunk null terminates its words, fills in its pointers and checks they are
+/// in order.  The list is only sorted if it turns out not to be.
 /// </summary>
 /// <returns>true on success, false on failure</returns>
 bool WordValidator::ProcessWordList()
 {
-	/* Step 1
-	Walk through the word list counting lines so that we know how many lines we are talking about.
-	This allows us to resize one time the final list so we can initialize it once (faster) instead
-	of just keep pushing back items on the container (triggering copy on resize).
-
+	/*
 	The text file I found (https://drive.google.com/file/d/0B9-WNydZzCHrdDVEc09CamJOZHc/view) has
 	each line end with \r\n.  Coding to allow for \n in case file edited on Linux.
 	*/
 	m_Strings.clear(); // set to empty
-	DWORD size = int(m_StringsBuffer.size());
-	DWORD count = 0; // count of words
-	const char *pCount = &m_StringsBuffer[0];
-	bool processessingSeperator = true; // trace we have hit \r or \n
-	for (DWORD i = 0; i < size; i++, pCount++)
+	m_replicas.clear(); // any copies of a list loaded before
+	m_wordCount = 0;
+	m_StringsBuffer.push_back('\0'); // terminates the last word if the file does not end with a new line
+	char *begin = &m_StringsBuffer[0];
+	char *end = begin + m_StringsBuffer.size() - 1;
+	size_t size = size_t(end - begin);
+
+	// Split into chunks, moving each boundary forward to a separator so no word spans two chunks
+	int threadCount = (size >= ParallelParseSize) ? GetWorkerThreadCount(0) : 1;
+	size_t chunkCount = size_t(threadCount) * 4;
+	std::vector<char*> bounds(chunkCount + 1);
+	bounds[0] = begin;
+	for (size_t nChunk = 1; nChunk < chunkCount; nChunk++)
+		bounds[nChunk] = std::max(bounds[nChunk - 1], const_cast<char*>(FindSeparator(begin + (size * nChunk) / chunkCount, end)));
+	bounds[chunkCount] = end;
+
+	// Step 1 - count the words in each chunk, then a running total gives where each chunk's words go
+	std::vector<size_t> offsets(chunkCount + 1, 0);
+	ParallelFor(chunkCount, threadCount, 1, [&](size_t nChunk, int)
 	{
-		if (('\r' == *pCount) || ('\n' == *pCount))
-		{
-			if (!processessingSeperator)
-			{
-				count++;
-				processessingSeperator = true;
-			}
-		}
-		else if (processessingSeperator)
+		offsets[nChunk + 1] = CountWords(bounds[nChunk], bounds[nChunk + 1]);
+	});
+	for (size_t nChunk = 0; nChunk < chunkCount; nChunk++)
+		offsets[nChunk + 1] += offsets[nChunk];
+
+	// Step 2 - null terminate the words, set up the pointers to them and check they are sorted
+	m_Strings.resize(offsets[chunkCount]); // one allocation, no copies as the list is filled
+	std::vector<char> chunkSorted(chunkCount, 1);
+	ParallelFor(chunkCount, threadCount, 1, [&](size_t nChunk, int)
+	{
+		chunkSorted[nChunk] = SplitWords(bounds[nChunk], bounds[nChunk + 1], m_Strings.data() + offsets[nChunk]) ? 1 : 0;
+	});
+
+	// Sorted if every chunk is sorted and the words either side of each chunk boundary are in order
+	bool sorted = true;
+	for (size_t nChunk = 0; sorted && (nChunk < chunkCount); nChunk++)
+	{
+		sorted = (0 != chunkSorted[nChunk]);
+		size_t first = offsets[nChunk];
+		if (sorted && (first > 0) && (first < m_Strings.size()))
+			sorted = !compareFunction(m_Strings[first], m_Strings[first - 1]);
+	}
+	if (!sorted)
+		std::sort(m_Strings.begin(), m_Strings.end(), compareFunction); // binary_search in isValid needs the list sorted
+	BuildHooks(threadCount);
+	m_wordCount = m_Strings.size();
+	if ((m_largePages || m_nodeReplicas) && (m_wordCount > 0))
+		PlaceLexicon(); // if it fails the lookups stay in the vectors
+	return m_wordCount > 0;
+}
+
+/// <summary>
+/// Builds the hash index of the words and then the hook masks.  A word's front hook is found from the
+/// longer word - every word of two or more letters is a hook of the word after its first letter (if that is
+/// a word) and of the word before its last letter - so it is two hash lookups a word rather than 52 per word.
+/// </summary>
+/// <param name="threadCount">Threads to use for finding the shorter words.</param>
+void WordValidator::BuildHooks(int threadCount)
+{
+	size_t count = m_Strings.size();
+	m_frontHooks.assign(count, 0);
+	m_backHooks.assign(count, 0);
+	size_t slotCount = 16;
+	while (slotCount < (count * 2)) // at most half full, so probe runs stay short
+		slotCount <<= 1;
+	size_t mask = slotCount - 1;
+	m_wordSlots.assign(slotCount, NoWord);
+	for (size_t nWord = 0; nWord < count; nWord++)
+	{
+		size_t slot = HashWord(m_Strings[nWord], strlen(m_Strings[nWord])) & mask;
+		while (NoWord != m_wordSlots[slot])
+			slot = (slot + 1) & mask;
+		m_wordSlots[slot] = uint32_t(nWord);
+	}
+
+	UseVectors();
+	const Lexicon &lexicon = m_lexicons[0];
+
+	// Step 1 - find the shorter words each word hooks onto (in parallel, nothing shared is written)
+	std::vector<uint32_t> frontOf(count, NoWord);
+	std::vector<uint32_t> backOf(count, NoWord);
+	ParallelFor(count, threadCount, 4096, [&](size_t nWord, int)
+	{
+		LPCSTR word = m_Strings[nWord];
+		size_t length = strlen(word);
+		if (length >= 2)
 		{
-			count++;
-			processessingSeperator = false;
+			frontOf[nWord] = FindIndex(lexicon, word + 1, length - 1);
+			backOf[nWord] = FindIndex(lexicon, word, length - 1);
 		}
-		// if not seperator or just comming off one just continue on through the word until the next seperator
+	});
+
+	// Step 2 - add each word's first/last letter to the shorter word's hooks
+	for (size_t nWord = 0; nWord < count; nWord++)
+	{
+		LPCSTR word = m_Strings[nWord];
+		if (NoWord != frontOf[nWord])
+			m_frontHooks[frontOf[nWord]] |= LetterBit(word[0]);
+		if (NoWord != backOf[nWord])
+			m_backHooks[backOf[nWord]] |= LetterBit(word[strlen(word) - 1]);
 	}
-	const char *last = &m_StringsBuffer[size - 1];
-	if (('\r' != *last) && ('\n' != *last))
-		count++; // get the final line "straggler"
 
-	/* Step 2
-	Now we know how many lines (words) we have so we can set up the pointers to the data and
-	NULL terminate the words by replacing the \r or \n (or both) to \0.
-	*/
-	m_Strings.reserve(count);
-	char *pData = &m_StringsBuffer[0];
-	processessingSeperator = true; // act as if we just had a CR so the first word will be added
-	for (DWORD i = 0; i < size; i++, pData++)
+	// The hash index finds the first of any repeated words (the list has a few), so copies get its hooks
+	for (size_t nWord = 1; nWord < count; nWord++)
 	{
-		switch (*pData)
+		if (0 == strcmp(m_Strings[nWord], m_Strings[nWord - 1]))
 		{
-		case '\r':
-			processessingSeperator = true;
-			*pData = '\0';
-			break;
-		case '\n':
-			processessingSeperator = true;
-			*pData = '\0';
-			break;
-		default:
-			if (processessingSeperator)
-			{
-				// This is the first line after CR, so we have something to add (our pointer into the buffer)
-				m_Strings.push_back(pData); // we have already done reserve so no new allocation is needed - avoid copy!
-				processessingSeperator = false;
-			}
-			break;
+			m_frontHooks[nWord] = m_frontHooks[nWord - 1];
+			m_backHooks[nWord] = m_backHooks[nWord - 1];
 		}
 	}
-	return !m_Strings.empty();
+}
+
+/// <summary>
+/// Finds a word (not null terminated, upper case as in the list) with the hash index.
+/// </summary>
+/// <returns>The index of the word in the list, or NoWord if it is not in the list</returns>
+uint32_t WordValidator::FindIndex(const Lexicon &lexicon, const char *word, size_t length) const
+{
+	if (0 == lexicon.m_slotCount)
+		return NoWord;
+	size_t mask = lexicon.m_slotCount - 1;
+	for (size_t slot = HashWord(word, length) & mask; NoWord != lexicon.m_wordSlots[slot]; slot = (slot + 1) & mask)
+	{
+		LPCSTR candidate = lexicon.m_strings[lexicon.m_wordSlots[slot]];
+		if ((0 == strncmp(candidate, word, length)) && ('\0' == candidate[length])) // strncmp stops at the end of a shorter candidate
+			return lexicon.m_wordSlots[slot];
+	}
+	return NoWord;
+}
+
+/// <summary>
+/// Points lookups at the vectors the list is built in.
+/// </summary>
+void WordValidator::UseVectors()
+{
+	Lexicon lexicon;
+	lexicon.m_strings = m_Strings.data();
+	lexicon.m_wordSlots = m_wordSlots.data();
+	lexicon.m_slotCount = m_wordSlots.size();
+	lexicon.m_frontHooks = m_frontHooks.data();
+	lexicon.m_backHooks = m_backHooks.data();
+	m_lexicons.assign(1, lexicon);
+}
+
+/// <summary>
+/// Copies the list (words, hash index and hooks) into one block of memory - on large pages if asked for,
+/// and one block per NUMA node if asked for - then frees the vectors.  The word pointers in each copy
+/// point to the words in that copy.
+/// </summary>
+/// <returns>true on success, false if the memory could not be allocated (lookups still use the vectors)</returns>
+bool WordValidator::PlaceLexicon()
+{
+	size_t count = m_Strings.size();
+	size_t slotCount = m_wordSlots.size();
+	size_t stringsSize = count * sizeof(LPCSTR);
+	size_t tablesSize = (slotCount + count * 2) * sizeof(uint32_t);
+	size_t size = stringsSize + tablesSize + m_StringsBuffer.size();
+	int nodeCount = m_nodeReplicas ? GetNumaNodeCount() : 1;
+
+	std::vector<Lexicon> lexicons;
+	std::vector<std::unique_ptr<NodeMemoryBlock>> replicas;
+	for (int node = 0; node < nodeCount; node++)
+	{
+		std::unique_ptr<NodeMemoryBlock> block(new NodeMemoryBlock());
+		if (!block->Allocate(size, (nodeCount > 1) ? node : -1, m_largePages))
+			return false;
+		char *data = static_cast<char*>(block->GetData());
+		LPCSTR *strings = reinterpret_cast<LPCSTR*>(data);
+		uint32_t *wordSlots = reinterpret_cast<uint32_t*>(data + stringsSize);
+		uint32_t *frontHooks = wordSlots + slotCount;
+		uint32_t *backHooks = frontHooks + count;
+		char *text = reinterpret_cast<char*>(backHooks + count);
+		memcpy(text, m_StringsBuffer.data(), m_StringsBuffer.size());
+		for (size_t nWord = 0; nWord < count; nWord++)
+			strings[nWord] = text + (m_Strings[nWord] - m_StringsBuffer.data());
+		memcpy(wordSlots, m_wordSlots.data(), slotCount * sizeof(uint32_t));
+		memcpy(frontHooks, m_frontHooks.data(), count * sizeof(uint32_t));
+		memcpy(backHooks, m_backHooks.data(), count * sizeof(uint32_t));
+
+		Lexicon lexicon;
+		lexicon.m_strings = strings;
+		lexicon.m_wordSlots = wordSlots;
+		lexicon.m_slotCount = slotCount;
+		lexicon.m_frontHooks = frontHooks;
+		lexicon.m_backHooks = backHooks;
+		lexicons.push_back(lexicon);
+		replicas.push_back(std::move(block));
+	}
+	m_lexicons.swap(lexicons);
+	m_replicas.swap(replicas);
+
+	// Only the copies are used from now on
+	std::vector<LPCSTR>().swap(m_Strings);
+	std::vector<char>().swap(m_StringsBuffer);
+	std::vector<uint32_t>().swap(m_wordSlots);
+	std::vector<uint32_t>().swap(m_frontHooks);
+	std::vector<uint32_t>().swap(m_backHooks);
+	return true;
+}
+
+/// <summary>
+/// Gets the copy of the list for the calling thread - the one on its NUMA node when there is a copy per node.
+/// </summary>
+const WordValidator::Lexicon &WordValidator::GetLexicon() const
+{
+	if (1 == m_lexicons.size())
+		return m_lexicons[0];
+	// The thread's node is looked up again every so often, in case the thread has been moved
+	static thread_local int node = 0;
+	static thread_local unsigned lookups = 0;
+	if (0 == (lookups++ % 256))
+		node = GetCurrentNumaNode();
+	return m_lexicons[(size_t(node) < m_lexicons.size()) ? size_t(node) : 0];
 }
 
 /// <summary>
@@ -101,15 +410,20 @@ bool WordValidator::ProcessWordList()
 /// <returns>true on success, false on failure</returns>
 bool WordValidator::Initialize(LPCSTR filename)
 {
-	std::ifstream file(filename);
-	std::string str;
+	std::ifstream file(filename, std::ios::binary);
+	if (!file)
+		return false;
 
 	file.seekg(0, std::ios::end);
-	m_StringsBuffer.reserve(DWORD(file.tellg())); // assume we will not have a file over 4GB in size
+	std::streamoff size = file.tellg();
 	file.seekg(0, std::ios::beg);
+	if (size <= 0)
+		return false;
 
-	m_StringsBuffer.assign((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
-	return ProcessWordList(); // return success/failure from parsing data
+	// Read the file in one block (ProcessWordList adds the terminator for the last word)
+	m_StringsBuffer.resize(size_t(size));
+	file.read(&m_StringsBuffer[0], size);
+	return file && ProcessWordList(); // return success/failure from parsing data
 }
 
 #if defined(_WIN32)
@@ -151,24 +465,6 @@ bool WordValidator::Initialize(int resourceID)
 }
 #endif
 
-/// <summary>
-/// compares two const char * data for the binary_search
-/// </summary>
-/// <param name="aux1">1st string</param>
-/// <param name="aux2">2nd string</param>
-/// <returns><c>true</c> if the 1st string is "less" than the 2nd, otherwise, <c>false</c>.</returns>
-bool compareFunction(const char *aux1, const char *aux2)
-{
-	if (strcmp(aux1, aux2) < 0)
-	{
-		return true;
-	}
-	else
-	{
-		return false;
-	}
-}
-
 /// <summary>
 /// Determines whether the specified word is valid (is in the list)
 /// </summary>
@@ -178,8 +474,42 @@ bool compareFunction(const char *aux1, const char *aux2)
 /// </returns>
 bool WordValidator::isValid(const std::string &word) const
 {
-	std::string upperWord = word;
-	transform(upperWord.begin(), upperWord.end(), upperWord.begin(), ::toupper);
-	bool found = std::binary_search(m_Strings.begin(), m_Strings.end(), upperWord.c_str(), compareFunction);
+	char buffer[64];
+	std::string upperWord;
+	const char *upper = UpperCase(word, buffer, upperWord);
+	const LPCSTR *strings = GetLexicon().m_strings;
+	bool found = std::binary_search(strings, strings + m_wordCount, upper, compareFunction);
+	return found;
+}
+
+/// <summary>
+/// Finds the word in the list with the hash index (any case).
+/// </summary>
+/// <param name="word">The word.</param>
+/// <param name="index">Set to the word's index (for GetWord, GetFrontHooks and GetBackHooks) when found.</param>
+/// <returns>true if the word is in the list</returns>
+bool WordValidator::FindWord(const std::string &word, size_t &index) const
+{
+	char buffer[64];
+	std::string upperWord;
+	uint32_t found = FindIndex(GetLexicon(), UpperCase(word, buffer, upperWord), word.length());
+	if (NoWord != found)
+		index = found;
+	return NoWord != found;
+}
+
+/// <summary>
+/// Gets the letters that can be put on the front or back of the word to make another word.
+/// </summary>
+/// <param name="word">The word (any case).</param>
+/// <param name="frontHooks">Set to the front hooks - bit 0 for 'A' to bit 25 for 'Z'.</param>
+/// <param name="backHooks">Set to the back hooks.</param>
+/// <returns>true if the word is in the list, otherwise false and no hooks</returns>
+bool WordValidator::GetHooks(const std::string &word, uint32_t &frontHooks, uint32_t &backHooks) const
+{
+	size_t index = 0;
+	bool found = FindWord(word, index);
+	frontHooks = found ? GetFrontHooks(index) : 0;
+	backHooks = found ? GetBackHooks(index) : 0;
 	return found;
 }
@@ -9,6 +9,9 @@ This file holds 276,653 words.
 #pragma once
 
 #include "string"
+#include "NodeMemory.h"
+#include <cstdint>
+#include <memory>
 #include <vector>
 
 class WordValidator
@@ -22,11 +25,57 @@ public:
 #endif
 	bool Initialize(LPCSTR filename); // Initialize using external textfile
 
+	// Memory for the list - set before Initialize.  Large pages cut the TLB misses of probing megabytes of words,
+	// and a copy per NUMA node lets each thread read the copy on its own node (see NodeMemory.h).
+	void SetLargePages(bool largePages) { m_largePages = largePages; }
+	void SetNodeReplicas(bool nodeReplicas) { m_nodeReplicas = nodeReplicas; }
+	bool IsOnLargePages() const { return !m_replicas.empty() && m_replicas[0]->IsLargePages(); }
+	bool IsHugePagesRequested() const { return !m_replicas.empty() && m_replicas[0]->IsHugePagesRequested(); } // may or may not be granted
+	size_t GetReplicaCount() const { return m_replicas.size(); } // 0 if the list is in normal (heap) memory
+
 	virtual bool isValid(const std::string &word) const;
+
+	// The loaded words in sorted order (null terminated, upper case as in the list) - for building indexes over the list
+	size_t GetWordCount() const { return m_wordCount; }
+	LPCSTR GetWord(size_t index) const { return GetLexicon().m_strings[index]; }
+
+	// Hooks - the single letters that can go on the front or back of a word to make another word in the list
+	// (bit 0 is 'A' ... bit 25 is 'Z').  Worked out when the list is loaded, so these are lookups, not searches.
+	bool FindWord(const std::string &word, size_t &index) const; // hashed, so O(1) - the index is as for GetWord
+	uint32_t GetFrontHooks(size_t index) const { return GetLexicon().m_frontHooks[index]; }
+	uint32_t GetBackHooks(size_t index) const { return GetLexicon().m_backHooks[index]; }
+	bool GetHooks(const std::string &word, uint32_t &frontHooks, uint32_t &backHooks) const; // false (no hooks) if not a word
+
 private:
+	// Where lookups read the list from - the vectors below, or a copy of them in a NodeMemoryBlock
+	class Lexicon
+	{
+	public:
+		const LPCSTR *m_strings;
+		const uint32_t *m_wordSlots;
+		size_t m_slotCount;
+		const uint32_t *m_frontHooks;
+		const uint32_t *m_backHooks;
+	};
+
 	bool ProcessWordList(); // Process the loaded word list, which will be stored in m_StringsBuffer
+	void BuildHooks(int threadCount); // Builds m_wordSlots and the hook masks from m_Strings
+	void UseVectors(); // lookups read the vectors
+	bool PlaceLexicon(); // copies the vectors to m_replicas (and frees them) for lookups to read
+	const Lexicon &GetLexicon() const; // the copy on the calling thread's NUMA node
+	uint32_t FindIndex(const Lexicon &lexicon, const char *word, size_t length) const; // index of the (upper case) word or NoWord
+
+	static const uint32_t NoWord = 0xFFFFFFFF;
 
+	bool m_largePages;
+	bool m_nodeReplicas;
+	size_t m_wordCount;
+	std::vector<Lexicon> m_lexicons; // one, or one per NUMA node (indexed by node)
+	std::vector<std::unique_ptr<NodeMemoryBlock>> m_replicas; // memory holding the copies, if placed
 	std::vector<LPCSTR> m_Strings; // Holds sorted list of pointers to strings in m_StringsBuffer
 	std::vector<char> m_StringsBuffer; // This holds a copy of the words
+	std::vector<uint32_t> m_wordSlots; // open addressing hash table of indexes into m_Strings (NoWord if empty)
+	std::vector<uint32_t> m_frontHooks; // per word, letters that can go in front of it
+	std::vector<uint32_t> m_backHooks; // per word, letters that can go after it
 };
 